@@ -4,18 +4,49 @@
 
 
 /****************** Include Files ********************/
+#include <stdbool.h>
 #include "xil_types.h"
 #include "xstatus.h"
 #include "xparameters.h"
 #include "xil_io.h"
+#include "axi_periph.h"
 
-#define PMODHB3_IP_S00_AXI_SLV_REG0_OFFSET 0
-#define PMODHB3_IP_S00_AXI_SLV_REG1_OFFSET 4
-#define PMODHB3_IP_S00_AXI_SLV_REG2_OFFSET 8
-#define PMODHB3_IP_S00_AXI_SLV_REG3_OFFSET 12
+#define PMODHB3_IP_S00_AXI_SLV_REG0_OFFSET 0	// RPM measured over the last tach window
+#define PMODHB3_IP_S00_AXI_SLV_REG1_OFFSET 4	// [9] enable, [8] direction, [7:0] duty cycle
+#define PMODHB3_IP_S00_AXI_SLV_REG2_OFFSET 8	// tach sample counter, +1 when a window closes
+#define PMODHB3_IP_S00_AXI_SLV_REG3_OFFSET 12	// AXI clock count when the last window closed
+
+#define PMODHB3_RPM_OFFSET			PMODHB3_IP_S00_AXI_SLV_REG0_OFFSET
+#define PMODHB3_CONFIG_OFFSET		PMODHB3_IP_S00_AXI_SLV_REG1_OFFSET
+#define PMODHB3_COUNT_OFFSET		PMODHB3_IP_S00_AXI_SLV_REG2_OFFSET
+#define PMODHB3_STAMP_OFFSET		PMODHB3_IP_S00_AXI_SLV_REG3_OFFSET
+
+// Tach counting window. Bitstreams without the sample counter leave REG2 at 0; a
+// reading is then taken as new when it changes or a whole window has gone by
+#define PMODHB3_TACH_WINDOW_US		200000
 
 
 /**************************** Type Definitions *****************************/
+/**
+ * One tach measurement
+ */
+typedef struct {
+    u32 rpm;            // RPM over the window
+    u32 count;          // sample counter (REG2)
+    u32 timestamp;      // AXI clock count at the end of the window (REG3)
+} PMODHB3_Sample;
+
+/**
+ * One PMODHB3 instance. Set up with PMODHB3_Initialize() before any other call
+ */
+typedef struct {
+    AXI_Periph io;
+    bool hasCounter;    // REG2 has been seen to move
+    u32 lastCount;      // tach sample tracking for PMODHB3_PollNewSample()
+    u32 lastRpm;
+    u32 lastFreshUs;
+} PMODHB3;
+
 /**
  *
  * Write a value to a PMODHB3_AXI_IP register. A 32 bit write is performed.
@@ -33,8 +64,13 @@
  * 	void PMODHB3_AXI_IP_mWriteReg(u32 BaseAddress, unsigned RegOffset, u32 Data)
  *
  */
+#ifdef HOST_BUILD
+#define PMODHB3_IP_mWriteReg(BaseAddress, RegOffset, Data) \
+  	PMODHB3_Sim_Write((BaseAddress) + (RegOffset), (u32)(Data))
+#else
 #define PMODHB3_IP_mWriteReg(BaseAddress, RegOffset, Data) \
   	Xil_Out32((BaseAddress) + (RegOffset), (u32)(Data))
+#endif
 
 /**
  *
@@ -53,8 +89,13 @@
  * 	u32 PMODHB3_AXI_IP_mReadReg(u32 BaseAddress, unsigned RegOffset)
  *
  */
+#ifdef HOST_BUILD
+#define PMODHB3_IP_mReadReg(BaseAddress, RegOffset) \
+    PMODHB3_Sim_Read((BaseAddress) + (RegOffset))
+#else
 #define PMODHB3_IP_mReadReg(BaseAddress, RegOffset) \
     Xil_In32((BaseAddress) + (RegOffset))
+#endif
 
 
 /************************** Function Prototypes ****************************/
@@ -78,8 +119,39 @@
  *
  */
 XStatus PMODHB3_IP_Reg_SelfTest(u32 baseaddr_p);
-XStatus PMODHB3_SetConfig(u32 baseAddress, u32 offset, u32 data);
-XStatus PMODHB3_Initialize(u32 baseaddr_p);
-u32 PMODHB3_GetRpm(u32 baseAddress, u32 offset);
+XStatus PMODHB3_Initialize(PMODHB3 *InstancePtr, u32 baseaddr_p);
+bool PMODHB3_PollNewSample(PMODHB3 *InstancePtr, PMODHB3_Sample *sample);
+XStatus PMODHB3_WaitForNewSample(PMODHB3 *InstancePtr, PMODHB3_Sample *sample, u32 timeout_us);
+bool PMODHB3_HasSampleCounter(const PMODHB3 *InstancePtr);
+
+/**
+ *
+ * Returns the RPM measured over the last tach window (REG0).
+ *
+ */
+static inline u32 PMODHB3_GetRpm(const PMODHB3 *InstancePtr)
+{
+    return AXI_Periph_Read(&InstancePtr->io, PMODHB3_RPM_OFFSET);
+}
+
+/**
+ *
+ * Writes the configuration register (REG1): [9] enable, [8] direction, [7:0] duty cycle.
+ *
+ */
+static inline void PMODHB3_SetConfig(const PMODHB3 *InstancePtr, u32 data)
+{
+    AXI_Periph_Write(&InstancePtr->io, PMODHB3_CONFIG_OFFSET, data);
+}
+
+#ifdef HOST_BUILD
+// Simulated register model, see PMODHB3_IP_sim.c
+void PMODHB3_Sim_Reset(u32 baseAddress, bool hasCounter);
+u32 PMODHB3_Sim_Read(u32 addr);
+void PMODHB3_Sim_Write(u32 addr, u32 data);
+void PMODHB3_Sim_SetMotor(u32 maxRpm, u32 tau_us);
+void PMODHB3_Sim_SetDeadband(u8 duty);
+void PMODHB3_Sim_SetReadDelay(u32 us);
+#endif
 
 #endif // PMODHB3_AXI_IP_H
@@ -8,6 +8,7 @@
 #include "xil_types.h"
 #include "xil_io.h"
 #include "xstatus.h"
+#include "axi_periph.h"
 
 #define PMODENC544_ROTARY_COUNT_REG_OFFSET 0
 #define PMODENC544_BTNSWT_REG_OFFSET 4
@@ -16,6 +17,13 @@
 
 
 /**************************** Type Definitions *****************************/
+/**
+ * One PmodENC544 instance. Set up with PMODENC544_initialize() before any other call
+ */
+typedef struct {
+    AXI_Periph io;
+} PMODENC544;
+
 /**
  *
  * Write a value to a PMODENC544 register. A 32 bit write is performed.
@@ -79,10 +87,35 @@
 XStatus PMODENC544_Reg_SelfTest(uint32_t baseaddr_p);
 
 // API function prototypes
-XStatus PMODENC544_initialize(uint32_t baseaddr_p);
-uint32_t PMODENC544_getRotaryCount(void);
-uint32_t PMODENC544_getBtnSwReg(void);
-uint32_t PMODENC544_clearRotaryCount(void);
-bool PMODENC544_isBtnPressed(void);
+XStatus PMODENC544_initialize(PMODENC544 *InstancePtr, uint32_t baseaddr_p);
+uint32_t PMODENC544_clearRotaryCount(const PMODENC544 *InstancePtr);
+
+/**
+ * Returns the rotary encoder count
+ *
+ */
+static inline uint32_t PMODENC544_getRotaryCount(const PMODENC544 *InstancePtr)
+{
+    return AXI_Periph_Read(&InstancePtr->io, PMODENC544_ROTARY_COUNT_REG_OFFSET);
+}
+
+/**
+ * Returns the PmodENC button and switch values.  button is returned in bit[0].
+ * switch is returned in bit[1].  All other bits are unused/reserved
+ *
+ */
+static inline uint32_t PMODENC544_getBtnSwReg(const PMODENC544 *InstancePtr)
+{
+    return AXI_Periph_Read(&InstancePtr->io, PMODENC544_BTNSWT_REG_OFFSET);
+}
+
+/**
+ * Returns true if the PmodENC button (the rotary encoder shaft) is pressed
+ *
+ */
+static inline bool PMODENC544_isBtnPressed(const PMODENC544 *InstancePtr)
+{
+    return (PMODENC544_getBtnSwReg(InstancePtr) & 0x1) ? true : false;
+}
 
 #endif // PMODENC544_H
@@ -0,0 +1,86 @@
+#ifndef AXI_PERIPH_H
+#define AXI_PERIPH_H
+
+
+/****************** Include Files ********************/
+#include <stdbool.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xil_io.h"
+
+/**
+ *
+ * Handle for one memory-mapped AXI peripheral.
+ *
+ * AXI_Periph_Init() checks the base address once. After that AXI_Periph_Read()
+ * and AXI_Periph_Write() are inlined bus accesses with no checks, so a driver
+ * keeps one handle per instance instead of a static base address and an
+ * isInitialized flag tested on every call.
+ *
+ * With HOST_BUILD the handle goes through a register file model instead of the
+ * bus. AXI_Periph_Init() gives it a plain RAM register file, and a driver with
+ * a behavioural model installs that with AXI_Periph_AttachSim(). Both paths
+ * are covered by the host tests in test/.
+ *
+ */
+
+/**************************** Type Definitions *****************************/
+#ifdef HOST_BUILD
+typedef u32 (*AXI_SimRead)(u32 addr);
+typedef void (*AXI_SimWrite)(u32 addr, u32 data);
+#endif
+
+typedef struct {
+    UINTPTR base;
+#ifdef HOST_BUILD
+    AXI_SimRead simRead;
+    AXI_SimWrite simWrite;
+#endif
+} AXI_Periph;
+
+#define AXI_PERIPH_SIM_REGS     16      // words in the RAM register file of one host handle
+
+
+/************************** Function Prototypes ****************************/
+XStatus AXI_Periph_Init(AXI_Periph *periph, UINTPTR baseaddr_p);
+
+#ifdef HOST_BUILD
+void AXI_Periph_AttachSim(AXI_Periph *periph, AXI_SimRead rd, AXI_SimWrite wr);
+#endif
+
+/**
+ *
+ * Reads a 32 bit register.
+ *
+ * @param   periph is a handle set up by AXI_Periph_Init().
+ * @param   offset is the register offset from the base.
+ *
+ */
+static inline u32 AXI_Periph_Read(const AXI_Periph *periph, u32 offset)
+{
+#ifdef HOST_BUILD
+    return periph->simRead(periph->base + offset);
+#else
+    return Xil_In32(periph->base + offset);
+#endif
+}
+
+/**
+ *
+ * Writes a 32 bit register.
+ *
+ * @param   periph is a handle set up by AXI_Periph_Init().
+ * @param   offset is the register offset from the base.
+ * @param   data is the value to write.
+ *
+ */
+static inline void AXI_Periph_Write(const AXI_Periph *periph, u32 offset, u32 data)
+{
+#ifdef HOST_BUILD
+    periph->simWrite(periph->base + offset, data);
+#else
+    Xil_Out32(periph->base + offset, data);
+#endif
+}
+
+#endif // AXI_PERIPH_H
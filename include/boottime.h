@@ -0,0 +1,32 @@
+/****************************************************************************************
+*   @file boottime.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Boot sequence timing. do_init() calls boot_mark() after every step and
+*         the control task calls boot_first_tick() on its first run, so the time
+*         from the timebase starting to the first control tick is known. The
+*         results are printed after start-up and on the console "boot" command:
+*             BOOT,<step>,<us>
+*             BOOT,first_tick,<us since the timebase started>
+*
+*******************************************************************************************/
+#ifndef __BOOTTIME_H__
+#define __BOOTTIME_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define BOOT_MAX_STEPS		12
+
+/**************Funtion Prototypes*****************/
+void boot_mark(const char *step);
+void boot_first_tick(void);
+u32 boot_first_tick_us(void);
+void boot_report(void);
+
+#endif
@@ -0,0 +1,115 @@
+/****************************************************************************************
+*   @file console.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Non-blocking UART command console for live parameter updates.
+*         console_task() drains at most CONSOLE_MAX_BYTES bytes from the UART
+*         receive FIFO per call and feeds them one at a time to the parser, so
+*         it never waits on the host.
+*
+*         Output, replies and everything printed with xil_printf() once the
+*         console is up, goes into a CONSOLE_TX_LEN byte ring. console_task()
+*         moves it to the transmit FIFO as the FIFO has room, so a multi-line
+*         reply does not hold up the scheduler for the time it takes to send.
+*         Only a reply longer than the ring waits, for the bytes that do not
+*         fit.
+*
+*         Text protocol, one command per line:
+*             get <param>             -> <param>=<value>
+*             set <param> <value>     -> OK | ERR
+*             list                    -> every parameter and its value
+*             <command>               -> application command (stats, mem, ...)
+*             pt <dt_ms> <rpm>        -> OK <reply> | FULL <reply> | ERR, see below
+*
+*         Binary protocol, fixed 8 byte request frames, little endian value:
+*             0xA5 cmd id v0 v1 v2 v3 chk
+*         cmd is CONSOLE_BIN_GET or CONSOLE_BIN_SET, id is the index of the
+*         parameter in the table (the value is ignored for a get) and chk is
+*         the XOR of cmd..v3. The 9 byte reply is
+*             0xA5 cmd|0x80 id status v0 v1 v2 v3 chk
+*         with the value of the parameter after the command and chk the XOR
+*         of cmd|0x80..v3.
+*         A frame whose bytes stop for a few milliseconds is dropped without
+*         a reply, so a lost byte costs one frame rather than the framing of
+*         every frame after it. A text line with more tokens than the command
+*         takes is answered with ERR.
+*
+*         CONSOLE_BIN_STREAM frames and "pt" lines go to the stream handler
+*         installed with console_set_stream() instead of the parameter table.
+*         The value carries a setpoint point, [15:0] signed RPM and [31:16]
+*         milliseconds since the previous point; the id is a sequence number
+*         the handler may ignore. The reply value is the handler's flow
+*         control credit. A "pt" line the handler refuses with
+*         CONSOLE_BIN_ERR_FULL is answered FULL, so the host can tell a point
+*         to resend from a line that was malformed or out of range (ERR).
+*
+*******************************************************************************************/
+#ifndef __CONSOLE_H__
+#define __CONSOLE_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+#include "xuartlite.h"
+
+/*********** Constants **********/
+#define CONSOLE_MAX_BYTES		16		// bytes parsed per console_task() call (one FIFO)
+#define CONSOLE_LINE_LEN		48
+#define CONSOLE_TX_LEN			1024	// transmit ring, must be a power of 2
+
+#define CONSOLE_BIN_SYNC		0xA5
+#define CONSOLE_BIN_GET			0x01
+#define CONSOLE_BIN_SET			0x02
+#define CONSOLE_BIN_STREAM		0x03
+#define CONSOLE_BIN_REPLY		0x80
+
+#define CONSOLE_BIN_OK			0x00
+#define CONSOLE_BIN_ERR_ID		0x01	// no such parameter
+#define CONSOLE_BIN_ERR_RANGE	0x02	// value out of range
+#define CONSOLE_BIN_ERR_CMD		0x03	// unknown command
+#define CONSOLE_BIN_ERR_CHK		0x04	// bad checksum
+#define CONSOLE_BIN_ERR_FULL	0x05	// stream handler cannot take the value now
+
+/*********** Type Definitions **********/
+// A parameter that can be read and written from the console
+typedef struct {
+	const char *name;
+	volatile void *ptr;
+	u8 size;				// 1, 2 or 4 bytes
+	bool is_signed;
+	int32_t min;
+	int32_t max;
+	void (*on_set)(void);	// called after a successful write, may be NULL
+} console_param_t;
+
+// An application command without arguments
+typedef struct {
+	const char *name;
+	void (*fn)(void);
+} console_cmd_t;
+
+/**
+ * Stream handler
+ *
+ * @param   seq     sequence number from the frame, 0 for a text line
+ * @param   value   [15:0] RPM, [31:16] milliseconds
+ * @param   reply   value sent back
+ *
+ * @return  CONSOLE_BIN_OK or a CONSOLE_BIN_ERR_* status
+ */
+typedef u8 (*console_stream_fn)(u8 seq, u32 value, int32_t *reply);
+
+/**************Funtion Prototypes*****************/
+void console_init(XUartLite *uart_inst, const console_param_t *params, u8 nparams,
+				  const console_cmd_t *cmds, u8 ncmds);
+void console_set_stream(console_stream_fn fn);
+void console_task(void);
+void console_putc(char c);
+void console_puts(const char *s);
+void console_putint(int32_t v);
+void outbyte(char c);
+
+#endif
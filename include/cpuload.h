@@ -0,0 +1,33 @@
+/****************************************************************************************
+*   @file cpuload.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note CPU load measurement. The scheduler adds the timebase ticks spent in
+*         every task (and the post-dispatch hook) to the task's busy_ticks.
+*         load_task() runs once per window, takes the difference of those
+*         counters against the ticks that elapsed on the free-running timer,
+*         and keeps the total and per-task load of the window just closed.
+*         Everything else is time the main loop spent polling the scheduler
+*         with nothing due, i.e. idle.
+*
+*         Loads are in tenths of a percent (0-1000).
+*
+*******************************************************************************************/
+#ifndef __CPULOAD_H__
+#define __CPULOAD_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include "xil_types.h"
+
+/**************Funtion Prototypes*****************/
+void load_init(void);
+void load_task(void);
+u16 load_total(void);
+u16 load_peak(void);
+u16 load_of_task(u8 id);
+void load_report(void);
+
+#endif
@@ -0,0 +1,70 @@
+/****************************************************************************************
+*   @file diag.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Diagnostics: runs the register self-test of every peripheral that has
+*         one and measures the read and write latency of each AXI slave with
+*         the timebase timer. One peripheral is handled per diag_step() call so
+*         the watchdog keeps being serviced. Results go out over the UART:
+*
+*             DIAG,begin,<timer ticks per us>
+*             DIAG,<name>,selftest,<PASS|FAIL|NONE>,<us>
+*             DIAG,<name>,rd,<min>,<avg>,<max>        latency in timer ticks
+*             DIAG,<name>,wr,<min>,<avg>,<max>
+*             DIAG,end,<failed self-tests>
+*
+*         The latency is the time of one access with the cost of reading the
+*         timer itself (also an AXI read) taken out. The self-tests overwrite
+*         peripheral registers, so the H-bridge is disabled first.
+*
+*         After the peripherals, the self-tests of the fixed-point arithmetic
+*         (scale) run one slice per step and report a selftest line only once
+*         they are done, with the time summed over their slices.
+*
+*******************************************************************************************/
+#ifndef __DIAG_H__
+#define __DIAG_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+#include "xstatus.h"
+
+/*********** Constants **********/
+#define DIAG_SAMPLES		64			// accesses timed per register
+#define DIAG_NO_WRITE		0xFFFFFFFF	// peripheral has no register that is safe to write
+
+/*********** Type Definitions **********/
+// An AXI slave to test
+typedef struct {
+	const char *name;
+	u32 base;
+	XStatus (*selftest)(u32 base);	// may be NULL
+	u32 rd_offset;					// register timed for reads
+	u32 wr_offset;					// register timed for writes (value read is written back)
+} diag_periph_t;
+
+// A self-test of software, run after the peripherals one slice per step
+typedef struct {
+	const char *name;
+	void (*start)(void);
+	bool (*step)(XStatus *result);	// true once done, with the result set
+} diag_calc_t;
+
+// Latency of one access type, in timer ticks
+typedef struct {
+	u32 min;
+	u32 avg;
+	u32 max;
+} diag_latency_t;
+
+/**************Funtion Prototypes*****************/
+void diag_start(void);
+bool diag_step(void);
+bool diag_running(void);
+u8 diag_failures(void);
+
+#endif
@@ -0,0 +1,53 @@
+/****************************************************************************************
+*   @file display.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Seven-segment display pages for RUN mode. The application supplies a
+*         table of pages, each reading its values through getter functions.
+*         disp_task() converts the values to SSEGHI/SSEGLO words in a cache,
+*         the selected page and one other page per call, so the control loop
+*         never formats anything and selecting a page is just the two register
+*         writes of its cached words. Only words that changed are written.
+*
+*         DISP_FMT_PAIR pages show two values of 0-9999 with leading zeros,
+*         one per bank (the RPM page). DISP_FMT_VALUE pages show the page
+*         number with its decimal point on digit 7 and one signed value of up
+*         to 6 digits right aligned on digits 5-0, clamped to the range.
+*
+*******************************************************************************************/
+#ifndef __DISPLAY_H__
+#define __DISPLAY_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define DISP_MAX_PAGES		8
+
+// Page formats
+#define DISP_FMT_PAIR		0		// get on digits 7-4, get_lo on digits 3-0
+#define DISP_FMT_VALUE		1		// page number on digit 7, get on digits 5-0
+
+/*********** Type Definitions **********/
+typedef int32_t (*disp_get_t)(void);
+
+typedef struct {
+	u8 fmt;
+	disp_get_t get;
+	disp_get_t get_lo;		// DISP_FMT_PAIR only, may be NULL otherwise
+} disp_page_t;
+
+/**************Funtion Prototypes*****************/
+void disp_init(const disp_page_t *pages, u8 npages);
+void disp_select(u8 page);
+void disp_next(void);
+void disp_prev(void);
+u8 disp_page(void);
+void disp_set_cycle(u16 ticks);
+void disp_task(bool active);
+
+#endif
@@ -0,0 +1,70 @@
+/****************************************************************************************
+*   @file fault.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Fault manager for the motor drive. Runs once per control tick, watches
+*         for stall, overspeed and tach sensor loss, and limits the PWM the
+*         controller is allowed to apply:
+*
+*         RUNNING   - normal operation
+*         DEGRADED  - a fault condition has been seen but not confirmed yet,
+*                     PWM is capped at FAULT_DEGRADED_PWM_MAX
+*         RAMP_DOWN - fault confirmed, PWM ramps to zero at FAULT_RAMP_PWM_PER_S
+*         STOPPED   - bridge disabled, automatic restart after FAULT_RETRY_US
+*         LATCHED   - bridge disabled until the operator clears the fault
+*
+*         The tach only updates once per counting window, whatever the loop
+*         rate. Fault conditions are therefore only checked on a new tach
+*         reading and confirmed over FAULT_CONFIRM_SAMPLES of them, and the
+*         ramp and retry times are in microseconds of the measured period.
+*         A stall needs the PWM to have been at or above FAULT_STALL_PWM for
+*         the whole window of the reading, so a start from rest is not one.
+*
+*******************************************************************************************/
+#ifndef __FAULT_H__
+#define __FAULT_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+// States
+#define FAULT_ST_RUNNING		0
+#define FAULT_ST_DEGRADED		1
+#define FAULT_ST_RAMP_DOWN		2
+#define FAULT_ST_STOPPED		3
+#define FAULT_ST_LATCHED		4
+
+// Fault codes
+#define FAULT_NONE				0
+#define FAULT_STALL				1	// PWM high but no rotation
+#define FAULT_OVERSPEED			2	// RPM above FAULT_OVERSPEED_RPM
+#define FAULT_SENSOR			3	// tach reading invalid
+#define FAULT_USER				4	// requested by the application (CRASH mode)
+
+// Thresholds
+#define FAULT_OVERSPEED_RPM		5750	// 15% above the highest setpoint (RPM_LIMIT_DEFAULT)
+#define FAULT_SENSOR_MAX_RPM	20000	// readings above this cannot be real
+#define FAULT_STALL_PWM			64		// PWM at or above which the motor must turn
+#define FAULT_CONFIRM_SAMPLES	3		// consecutive tach readings to confirm a fault condition
+#define FAULT_DEGRADED_PWM_MAX	100
+#define FAULT_RAMP_PWM_PER_S	200		// PWM decrease per second while ramping down
+#define FAULT_RETRY_US			2000000	// time in STOPPED before an automatic restart
+#define FAULT_MAX_RETRIES		3		// trips before the fault is latched
+
+/**************Funtion Prototypes*****************/
+void fault_init(void);
+u8 fault_step(u32 rpm_raw, bool fresh, u32 dt_us, u8 pwm_cmd);
+void fault_raise(u8 fault);
+bool fault_clear(void);
+
+u8 fault_state(void);
+u8 fault_code(void);
+bool fault_bridge_enabled(void);
+const char *fault_state_str(u8 state);
+
+#endif
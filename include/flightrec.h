@@ -0,0 +1,91 @@
+/****************************************************************************************
+*   @file flightrec.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Flight recorder for the control loop. The last FR_DEPTH control ticks
+*         are kept in a circular buffer in .noinit BRAM, so they survive a
+*         watchdog reset. The control tick fills the slot returned by fr_next()
+*         in place and calls fr_commit(), which is all it costs per tick.
+*
+*         The recorder triggers on a confirmed fault, on the condition set with
+*         fr_set_trigger() or on fr_trigger(). It keeps recording for
+*         FR_POST_TRIGGER more ticks so that the ramp-down is captured as well,
+*         then freezes until fr_arm() is called. The first event is kept, later
+*         ones are not recorded until the recorder is re-armed.
+*
+*         fr_dump_start() prints the frozen buffer over the UART from fr_task(),
+*         a few lines per call, oldest sample first:
+*             FR,<cause>,<samples>
+*             FR,<i>,<t_us>,<stpt>,<rpm>,<error>,<integ>,<pwm>,<sw>,<btn>,<status>,<fault>,<dt_us>
+*             FR,end
+*
+*******************************************************************************************/
+#ifndef __FLIGHTREC_H__
+#define __FLIGHTREC_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define FR_DEPTH			128		// samples kept, must be a power of 2
+#define FR_POST_TRIGGER		16		// samples recorded after the trigger
+#define FR_DUMP_LINES		2		// samples printed per fr_task() call
+
+// Freeze causes
+#define FR_CAUSE_NONE		0		// still recording
+#define FR_CAUSE_FAULT		1		// fault manager confirmed a fault
+#define FR_CAUSE_TRIGGER	2		// trigger condition met
+#define FR_CAUSE_MANUAL		3		// fr_trigger() or a dump of a live buffer
+#define FR_CAUSE_RESET		4		// the system was reset while recording
+
+// Trigger conditions
+#define FR_TRIG_NONE		0
+#define FR_TRIG_ERROR		1		// |error| above the level
+#define FR_TRIG_RPM			2		// |rpm| above the level
+
+// Status byte fields
+#define FR_STATUS(mode, dir, rev, fault_st)	\
+	((u8)((mode) & 0x3) | (u8)((dir) & 0x1) << 2 | (u8)((rev) & 0x3) << 3 | (u8)((fault_st) & 0x7) << 5)
+
+/*********** Type Definitions **********/
+// One control tick, 20 bytes. Fields are ordered so there is no padding and every
+// field stays naturally aligned; a packed attribute would turn them into byte stores
+typedef struct {
+	u32 t_us;				// timebase at the end of the tick
+	int16_t stpt;			// signed setpoint the controller tracked
+	int16_t rpm;			// signed measured speed
+	int16_t error;			// error in PWM counts
+	int16_t integ;			// integrator, saturated to 16 bits
+	u16 sw;					// switches
+	u8 pwm;					// duty cycle written to the bridge
+	u8 btn;					// [4:0] buttons, [5] encoder button, [6] encoder switch
+	u8 status;				// FR_STATUS(): mode, direction bit, reversal state, fault state
+	u8 fault;				// FAULT_* code
+	u16 dt_us;				// measured control period, saturated
+} fr_sample_t;
+
+/**************Funtion Prototypes*****************/
+void fr_init(bool preserve);
+fr_sample_t *fr_next(void);
+void fr_commit(bool fault);
+void fr_trigger(void);
+void fr_set_trigger(u8 type, u16 level);
+void fr_arm(void);
+
+bool fr_frozen(void);
+u8 fr_cause(void);
+u16 fr_count(void);
+
+void fr_dump_start(void);
+void fr_task(void);
+
+static inline int16_t fr_sat16(int32_t v)
+{
+	return (v > INT16_MAX) ? INT16_MAX : (v < INT16_MIN) ? INT16_MIN : (int16_t)v;
+}
+
+#endif
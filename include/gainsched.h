@@ -0,0 +1,47 @@
+/****************************************************************************************
+*   @file gainsched.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Gain scheduling across the RPM range. A gain set (same layout as kpid:
+*         [0] kp, [1] kd, [2] ki) is held at each of GS_NUM_POINTS RPM
+*         breakpoints. Every control tick the breakpoint below the scheduling
+*         speed is found by binary search and the gains are interpolated
+*         linearly towards the next one. The per-segment slopes are kept in Q16
+*         and only recomputed when the table is edited, so the lookup has no
+*         division. Below the first and above the last breakpoint the end gains
+*         are used.
+*
+*******************************************************************************************/
+#ifndef __GAINSCHED_H__
+#define __GAINSCHED_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define GS_NUM_POINTS		8
+#define GS_NUM_GAINS		3		// kp, kd, ki, indexed like kpid
+#define GS_GAIN_MAX			255
+
+// Scheduling variable
+#define GS_SRC_SETPOINT		0		// setpoint the controller tracks
+#define GS_SRC_MEASURED		1		// tach speed
+
+/**************Funtion Prototypes*****************/
+void gs_init(void);
+void gs_set_enabled(bool en, const u16 *seed);
+bool gs_enabled(void);
+
+u16 *gs_point_gains(u8 idx);
+void gs_update(void);
+bool gs_set_rpm(u8 idx, u16 rpm);
+u16 gs_point_rpm(u8 idx);
+
+void gs_gains(u16 rpm, u16 *k);
+void gs_report(void);
+
+#endif
@@ -0,0 +1,43 @@
+/****************************************************************************************
+*   @file idle.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Idle loop. When the scheduler has nothing due, idle_wait() arms the
+*         timer alarm for the next task release and sleeps until an interrupt.
+*         The UART receive interrupt kicks the console task, so a command is
+*         handled as soon as its first byte arrives instead of at the next
+*         console release.
+*
+*         With IDLE_USE_MBAR=1 (the default) the processor sleeps on "mbar 16".
+*         Build with -DIDLE_USE_MBAR=0 for a MicroBlaze without sleep support;
+*         the idle loop then spins on a flag set by the interrupt handlers.
+*
+*         On the host there are no interrupts and idle_wait() advances the
+*         virtual timebase to the next release.
+*
+*******************************************************************************************/
+#ifndef __IDLE_H__
+#define __IDLE_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include "xil_types.h"
+#include "xstatus.h"
+#include "xintc.h"
+
+/*********** Constants **********/
+#ifndef IDLE_USE_MBAR
+#define IDLE_USE_MBAR		1
+#endif
+
+// Releases closer than this are polled for instead of slept for. Also keeps the
+// alarm from expiring between enabling interrupts and the sleep instruction
+#define IDLE_MIN_SLEEP_US	20
+
+/**************Funtion Prototypes*****************/
+XStatus idle_init(XIntc *intc, u8 uart_task);
+void idle_wait(u32 until_us);
+
+#endif
@@ -0,0 +1,135 @@
+/****************************************************************************************
+*   @file log.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Logging macros with compile-time filtering.
+*
+*         LOG_ERR/LOG_WARN/LOG_INFO/LOG_DEBUG(module, fmt, ...) take a module
+*         name (UI, CTRL, FAULT, SYS). A call is compiled in only if its level
+*         is at or below LOG_LEVEL and LOG_EN_<module> is 1, otherwise it
+*         expands to ((void)0) and its arguments are never evaluated. Both are
+*         set from the compiler command line, e.g. -DLOG_LEVEL=LOG_LEVEL_ERR
+*         -DLOG_EN_UI=0 for a production build.
+*
+*         With LOG_DEFERRED=1 nothing is formatted on the target. The format
+*         string goes into the non-allocated .logstr section, so it costs no
+*         BRAM, and its address in that section is the string id. Each call
+*         stores the id, a timestamp and up to LOG_MAX_ARGS integer arguments
+*         in a ring buffer, which log_task() drains over the UART as
+*         LOG,<header>,<time>,<args...> hex lines for scripts/logdecode.py to
+*         format on the host. %s arguments cannot be decoded in this mode.
+*
+*******************************************************************************************/
+#ifndef __LOG_H__
+#define __LOG_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include "xil_types.h"
+#include "xil_printf.h"
+
+/*********** Constants **********/
+#define LOG_LEVEL_NONE		0
+#define LOG_LEVEL_ERR		1
+#define LOG_LEVEL_WARN		2
+#define LOG_LEVEL_INFO		3
+#define LOG_LEVEL_DEBUG		4
+
+// Highest level compiled in
+#ifndef LOG_LEVEL
+#define LOG_LEVEL			LOG_LEVEL_INFO
+#endif
+
+// 1 to log into the ring buffer instead of printing
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED		0
+#endif
+
+// Per-module enables, 0 compiles every call of that module out
+#ifndef LOG_EN_UI
+#define LOG_EN_UI			1		// SET/RUN mode user interface
+#endif
+#ifndef LOG_EN_CTRL
+#define LOG_EN_CTRL			1		// control loop
+#endif
+#ifndef LOG_EN_FAULT
+#define LOG_EN_FAULT		1		// fault handling
+#endif
+#ifndef LOG_EN_SYS
+#define LOG_EN_SYS			1		// start-up and system services
+#endif
+
+#define LOG_MAX_ARGS		4
+#define LOG_RING_WORDS		256		// must be a power of 2
+#define LOG_FLUSH_RECORDS	8		// records printed per log_task() call
+
+// Record header: [15:0] string id, [18:16] argument count, [21:19] level,
+// [31:24] sequence number so the host can spot dropped records
+#define LOG_HDR(id, n, lvl, seq)	(((u32)(id) & 0xFFFF) | (u32)(n) << 16 | (u32)(lvl) << 19 | (u32)(seq) << 24)
+
+/*********** Macros **********/
+#define LOG_CAT(a, b)		LOG_CAT_(a, b)
+#define LOG_CAT_(a, b)		a##b
+
+// Selects LOG_IF_0 or LOG_IF_1 from the module enable
+#define LOG_IF(mod)			LOG_CAT(LOG_IF_, LOG_EN_##mod)
+#define LOG_IF_0(...)		((void)0)
+#define LOG_IF_1(...)		LOG_EMIT(__VA_ARGS__)
+
+#if LOG_DEFERRED
+// Counts 0 to LOG_MAX_ARGS variadic arguments
+#define LOG_NARG(...)		LOG_NARG_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_NARG_(z, a, b, c, d, n, ...)	n
+
+#define LOG_ARGS(...)		LOG_CAT(LOG_ARGS_, LOG_NARG(__VA_ARGS__))(__VA_ARGS__)
+#define LOG_ARGS_0()
+#define LOG_ARGS_1(a)				, (u32)(uintptr_t)(a)
+#define LOG_ARGS_2(a, b)			LOG_ARGS_1(a) LOG_ARGS_1(b)
+#define LOG_ARGS_3(a, b, c)			LOG_ARGS_2(a, b) LOG_ARGS_1(c)
+#define LOG_ARGS_4(a, b, c, d)		LOG_ARGS_3(a, b, c) LOG_ARGS_1(d)
+
+#define LOG_EMIT(lvl, fmt, ...)													\
+	do {																		\
+		static const char log_fmt_[] __attribute__((section(".logstr"))) = fmt;	\
+		const u32 log_args_[] = { 0 LOG_ARGS(__VA_ARGS__) };					\
+		log_write(LOG_HDR((uintptr_t)log_fmt_, LOG_NARG(__VA_ARGS__), lvl, 0),	\
+				  &log_args_[1]);												\
+	} while (0)
+#else
+#define LOG_EMIT(lvl, fmt, ...)		xil_printf(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERR
+#define LOG_ERR(mod, fmt, ...)		LOG_IF(mod)(LOG_LEVEL_ERR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERR(mod, fmt, ...)		((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(mod, fmt, ...)		LOG_IF(mod)(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(mod, fmt, ...)		((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(mod, fmt, ...)		LOG_IF(mod)(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(mod, fmt, ...)		((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(mod, fmt, ...)	LOG_IF(mod)(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(mod, fmt, ...)	((void)0)
+#endif
+
+/**************Funtion Prototypes*****************/
+#if LOG_DEFERRED
+void log_write(u32 hdr, const u32 *args);
+void log_task(void);
+u32 log_dropped(void);
+#endif
+
+#endif
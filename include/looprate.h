@@ -0,0 +1,59 @@
+/****************************************************************************************
+*   @file looprate.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Control loop rate selection and discrete gain rescaling. The control
+*         task period is selected at runtime from a fixed table of rates. The
+*         actual period is measured from the timebase on every tick and the
+*         discrete I and D gains are derived from it, so that one set of kpid
+*         values behaves the same at every rate:
+*
+*             u = kp * e + ki * sum(e) * dt + kd * (e - e_prev) / dt,   dt in seconds
+*
+*         The I gain is kept in Q16, the D gain as an integer per-tick factor.
+*         dt and 1/dt are only recomputed (64-bit divide) when the measured
+*         period moves more than 1/8 away from the one the gains were computed
+*         for. A change of kpid, which gain scheduling can make on every tick,
+*         rescales the gains with multiplies only.
+*
+*******************************************************************************************/
+#ifndef __LOOPRATE_H__
+#define __LOOPRATE_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+// Selectable loop rates
+#define LOOP_RATE_5HZ		0		// legacy rate, one tach window per tick
+#define LOOP_RATE_100HZ		1
+#define LOOP_RATE_500HZ		2
+#define LOOP_RATE_1KHZ		3
+#define LOOP_RATE_2KHZ		4
+#define LOOP_NUM_RATES		5
+
+/*********** Type Definitions **********/
+// Discrete gains for the measured period
+typedef struct {
+	int32_t kp;				// proportional gain
+	int32_t ki_dt_q16;		// ki * dt, Q16
+	int32_t kd_over_dt;		// kd / dt
+	u32 dt_us;				// period these gains were computed for
+} loop_gains_t;
+
+/**************Funtion Prototypes*****************/
+void looprate_init(u8 task_id, u8 rate);
+void looprate_select(u8 rate);
+u8 looprate_get(void);
+u32 looprate_period_us(void);
+u32 looprate_hz(u8 rate);
+
+u32 looprate_tick(void);
+u32 looprate_last_dt_us(void);
+const loop_gains_t *looprate_gains(u16 kp, u16 ki, u16 kd);
+
+#endif
@@ -0,0 +1,40 @@
+/****************************************************************************************
+*   @file memmon.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Stack and heap usage monitor. The unused part of the stack and the
+*         whole heap are painted with a known pattern at boot. The high-water
+*         mark is the furthest address whose paint has been overwritten.
+*
+*         memmon_sample() runs after every scheduler dispatch. It scans the
+*         still-painted words below the current stack mark, so the task that
+*         pushed the stack deepest is known. memmon_task() runs at low priority,
+*         rescans both regions and reports them over the UART.
+*
+*******************************************************************************************/
+#ifndef __MEMMON_H__
+#define __MEMMON_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define MEMMON_PAINT			0x5AA5C33Cu
+#define MEMMON_REPORT_TICKS		10			// memmon_task() calls between unconditional reports
+
+/**************Funtion Prototypes*****************/
+void memmon_init(void);
+void memmon_sample(u8 task_id);
+void memmon_task(void);
+
+u32 memmon_stack_size(void);
+u32 memmon_stack_high_water(void);
+u8 memmon_deepest_task(void);
+u32 memmon_heap_size(void);
+u32 memmon_heap_high_water(void);
+void memmon_report(void);
+
+#endif
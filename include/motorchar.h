@@ -0,0 +1,109 @@
+/****************************************************************************************
+*   @file motorchar.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Open-loop motor characterization. mchar_step() runs once per control
+*         tick in CHAR mode and returns the PWM to apply:
+*
+*         STOP  - PWM 0 until MCHAR_STOP_WINDOWS tach readings in a row are
+*                 below MCHAR_STOPPED_RPM
+*         STEP  - a staircase through MCHAR_NUM_STEPS PWM levels, each held
+*                 for MCHAR_STEP_WINDOWS tach windows. A level is applied on
+*                 the tick a new tach reading arrives, so the steps line up
+*                 with the counting windows
+*         FIT   - PWM 0, mchar_task() fits the trace
+*
+*         Every tach reading, the fastest the speed can be sampled, is stored
+*         in a BRAM trace. The fit gives:
+*
+*         gain      - least squares slope of the settled speed of each level
+*                     that turns the motor against its PWM, RPM per count Q8
+*         deadband  - PWM at which that line crosses zero speed
+*         tau       - time constant from the area between each step response
+*                     and its settled speed, area = tau * (w_end - w_start).
+*                     A tach reading is the mean speed over its window, so the
+*                     sum of window means times the window length is that area
+*                     exactly
+*         rpm_max   - settled speed at full PWM
+*
+*         A level lasts 3 s, long enough to settle for tau up to about 0.5 s.
+*         The fit needs the sample counter in the bitstream; without it the
+*         steps do not line up with the windows and tau is coarse.
+*
+*         mchar_report() prints the state and the last successful fit:
+*             CHAR,state,<MCHAR_*>,<reason if failed>
+*             CHAR,fit,<gain_q8>,<deadband>,<tau_us>,<rpm_max>
+*
+*         mchar_dump_start() prints the trace from mchar_task(), a few lines
+*         per call:
+*             CHAR,trace,<samples>
+*             CHAR,<i>,<t_us>,<pwm>,<rpm>
+*             CHAR,end
+*
+*******************************************************************************************/
+#ifndef __MOTORCHAR_H__
+#define __MOTORCHAR_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+// States
+#define MCHAR_IDLE				0
+#define MCHAR_STOP				1
+#define MCHAR_STEP				2
+#define MCHAR_FIT				3
+#define MCHAR_DONE				4
+#define MCHAR_FAILED			5
+
+#define MCHAR_NUM_STEPS			8		// PWM levels of the staircase
+#define MCHAR_STEP_WINDOWS		15		// tach windows each level is held for
+#define MCHAR_SS_WINDOWS		3		// last windows of a level averaged for its settled speed
+#define MCHAR_TRACE_LEN			128		// samples kept, one per tach window
+#define MCHAR_DUMP_LINES		2		// samples printed per mchar_task() call
+
+#define MCHAR_STOPPED_RPM		20		// speed the motor counts as stopped below
+#define MCHAR_STOP_WINDOWS		3		// readings in a row that have to be stopped
+#define MCHAR_STOP_TIMEOUT		50		// windows before giving up on the motor stopping
+#define MCHAR_MOVE_RPM			50		// settled speed a level has to reach to be fitted
+#define MCHAR_MIN_DELTA_RPM		100		// smallest step response used for tau
+#define MCHAR_MIN_FULL_RPM		500		// rpm_max below this means no motor
+
+// Used until a characterization succeeds
+#define MCHAR_DEFAULT_START_PWM	0x1f	// kick given by the first RUN tick
+
+/*********** Type Definitions **********/
+// One tach reading, 8 bytes
+typedef struct {
+	u32 t_us;				// timebase when the reading was seen
+	u16 rpm;				// speed, mean over the window
+	u8 pwm;					// duty cycle applied during the window
+	u8 step;				// staircase level, 0 for the stopped baseline
+} mchar_sample_t;
+
+typedef struct {
+	u32 gain_q8;			// RPM per PWM count above the deadband, Q8
+	u32 tau_us;				// mechanical time constant
+	u16 rpm_max;			// settled speed at PWM 255
+	u8 deadband;			// PWM at which the motor starts to turn
+	bool valid;				// a characterization has succeeded
+} mchar_result_t;
+
+/**************Funtion Prototypes*****************/
+void mchar_start(void);
+void mchar_abort(void);
+u8 mchar_step(u32 rpm, bool fresh, u32 now_us);
+void mchar_task(void);
+
+u8 mchar_state(void);
+bool mchar_running(void);
+const mchar_result_t *mchar_result(void);
+u8 mchar_start_pwm(void);
+void mchar_report(void);
+void mchar_dump_start(void);
+
+#endif
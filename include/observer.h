@@ -0,0 +1,63 @@
+/****************************************************************************************
+*   @file observer.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Luenberger speed observer. The tach only updates once per counting
+*         window (OBS_TACH_WINDOW_US), so at higher loop rates the controller
+*         would act on the same stale reading many times. The observer runs a
+*         first-order motor model every control tick
+*
+*             w' = (K * u + b - w) / tau,     u = signed PWM applied last tick
+*
+*         and corrects the estimate when a new tach reading arrives. The tach
+*         value is the average speed over its window, so the innovation is taken
+*         against the average of the estimate over the same window:
+*
+*             w += L * (tach - mean(w over the window))
+*             b += Lb * (tach - mean(w over the window))
+*
+*         The bias b soaks up load torque and error in K, so the estimate has
+*         no steady-state offset from the tach.
+*         Everything is integer: speed in Q8 RPM, the model step dt/tau and the
+*         observer gain L in Q16. The only divisions happen when tau changes,
+*         when the measured period moves more than 1/8 away from the one the
+*         model step was computed for, and once per tach window.
+*
+*******************************************************************************************/
+#ifndef __OBSERVER_H__
+#define __OBSERVER_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+#include "PMODHB3_IP.h"
+
+/*********** Constants **********/
+#define OBS_TACH_WINDOW_US		PMODHB3_TACH_WINDOW_US
+#define OBS_RESEED_US			(2 * OBS_TACH_WINDOW_US)	// longer gaps restart from the tach
+
+// Default model: full PWM (255) reaches about 6000 RPM
+#define OBS_DEFAULT_K_Q8		6023		// RPM per PWM count, Q8
+#define OBS_DEFAULT_TAU_US		150000		// mechanical time constant
+#define OBS_DEFAULT_L_Q16		32768		// 0.5
+#define OBS_BIAS_L_Q16			16384		// 0.25, gain of the model bias state
+
+// Feedback selection
+#define OBS_MODE_OFF			0		// controller uses the tach
+#define OBS_MODE_ON				1		// controller uses the estimate
+#define OBS_MODE_AUTO			2		// estimate only when the loop is faster than the tach
+
+/**************Funtion Prototypes*****************/
+void obs_init(void);
+void obs_set_model(u32 k_q8, u32 tau_us);
+void obs_set_gain(u32 l_q16);
+void obs_reset(int32_t rpm);
+
+int32_t obs_step(u32 dt_us, int32_t rpm_meas, bool fresh);
+void obs_input(int32_t pwm);
+int32_t obs_estimate(void);
+
+#endif
@@ -0,0 +1,71 @@
+/****************************************************************************************
+*   @file pidcore.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note P/I/D control law variants. Each of the eight combinations of the P,
+*         I and D terms is generated from one macro with the term enables as
+*         constants, so the compiler drops the code of a disabled term
+*         altogether. pid_law() picks a variant from the sw[2:0] bits once per
+*         tick instead of multiplying every term by its switch.
+*
+*         A variant without the I term holds the integrator at 0, so enabling
+*         the term later starts it from rest. The anti-windup policy is chosen
+*         at compile time with -DPID_ANTI_WINDUP=PID_AW_CLAMP; the default
+*         integrates unconditionally as before. Either way the integrator
+*         saturates at the int32 limits rather than overflowing.
+*
+*         pid_bumpless() gives bumpless transfer: it sets the integrator so
+*         that a law, with new gains or terms, produces a given output this
+*         tick, and the output carries on from there instead of stepping.
+*         Only a law with the I term can absorb the difference.
+*
+*******************************************************************************************/
+#ifndef __PIDCORE_H__
+#define __PIDCORE_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include "xil_types.h"
+#include "looprate.h"
+
+/*********** Constants **********/
+// Anti-windup policies
+#define PID_AW_NONE			0		// always integrate
+#define PID_AW_CLAMP		1		// don't integrate further into saturation
+
+#ifndef PID_ANTI_WINDUP
+#define PID_ANTI_WINDUP		PID_AW_NONE
+#endif
+
+#define PID_OUT_MAX			255		// controller output magnitude the clamp works against
+
+// Term bits, laid out like sw[2:0]
+#define PID_TERM_D			0x1
+#define PID_TERM_I			0x2
+#define PID_TERM_P			0x4
+#define PID_NUM_LAWS		8
+
+#define PID_BENCH_ITERS		1000
+
+/*********** Type Definitions **********/
+/**
+ * One control law
+ *
+ * @param   g       discrete gains for the measured period
+ * @param   e       error this tick
+ * @param   de      error change since the last tick
+ * @param   integ   integrator, updated by the law
+ *
+ * @return  unclipped controller output
+ */
+typedef int64_t (*pid_law_t)(const loop_gains_t *g, int32_t e, int32_t de, int32_t *integ);
+
+/**************Funtion Prototypes*****************/
+pid_law_t pid_law(u8 terms);
+void pid_bumpless(u8 terms, const loop_gains_t *g, int32_t e, int32_t de, int64_t u, int32_t *integ);
+const char *pid_law_name(u8 terms);
+void pid_bench(void);
+
+#endif
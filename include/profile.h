@@ -0,0 +1,57 @@
+/****************************************************************************************
+*   @file profile.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Streamed setpoint profile. The host sends (dt, RPM) points over the
+*         console, dt being the milliseconds from the previous point (from the
+*         start of playback for the first one). They are queued in a ring of
+*         PROF_DEPTH points. Every control tick prof_setpoint() interpolates
+*         linearly along the current segment; the slope is worked out once per
+*         segment in Q32 RPM per microsecond, so a tick has no division and a
+*         slow ramp still moves smoothly.
+*
+*         Flow control: every point is answered with the number of free
+*         slots, and a point sent to a full ring is refused with FULL (status
+*         CONSOLE_BIN_ERR_FULL in a binary frame) and the host resends it. Playback only starts once PROF_START_POINTS points are queued,
+*         so the host is a few segments ahead. A point with dt = PROF_END_DT
+*         ends the profile. If the ring runs dry before that the setpoint is
+*         held, an underrun is counted and playback carries on from the next
+*         point that arrives.
+*
+*******************************************************************************************/
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define PROF_DEPTH			64			// must be a power of 2
+#define PROF_START_POINTS	8			// points queued before playback starts
+#define PROF_END_DT			0xFFFF		// dt of the end-of-profile marker
+
+// Playback states
+#define PROF_IDLE			0			// not playing, setpoint held
+#define PROF_ARMED			1			// waiting for PROF_START_POINTS points
+#define PROF_PLAYING		2
+#define PROF_STARVED		3			// ring ran dry, setpoint held
+#define PROF_DONE			4			// end marker reached, setpoint held
+
+/**************Funtion Prototypes*****************/
+void prof_init(void);
+bool prof_push(u16 dt_ms, int16_t rpm);
+u8 prof_free(void);
+void prof_play(void);
+void prof_stop(void);
+void prof_clear(void);
+int32_t prof_setpoint(u16 limit);
+int32_t prof_current(void);
+u8 prof_state(void);
+void prof_report(void);
+u8 prof_stream(u8 seq, u32 value, int32_t *reply);
+
+#endif
@@ -0,0 +1,53 @@
+/****************************************************************************************
+*   @file reversal.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Direction reversal sequencer. The tach only measures speed, not direction,
+*         so the H-bridge direction may only change once the motor is (nearly)
+*         stopped. When the sign of the setpoint changes the sequencer:
+*
+*         DECEL - commands zero speed in the current direction until the measured
+*                 speed drops below REV_THRESHOLD_RPM
+*         DWELL - holds the bridge in coast (enable off) or brake (enable on,
+*                 duty 0) for REV_DWELL_US
+*         DRIVE - flips the direction bit and re-accelerates to the new setpoint
+*
+*         The controller works in signed velocity: positive is the direction the
+*         encoder calls clockwise. The measured speed is signed with the direction
+*         that is currently applied to the bridge.
+*
+*******************************************************************************************/
+#ifndef __REVERSAL_H__
+#define __REVERSAL_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+// States
+#define REV_DRIVE			0
+#define REV_DECEL			1
+#define REV_DWELL			2
+
+// Bridge behaviour during the dwell
+#define REV_DWELL_COAST		0
+#define REV_DWELL_BRAKE		1
+
+#define REV_THRESHOLD_RPM	150		// speed below which the direction may be flipped
+#define REV_DWELL_US		200000	// time spent coasting/braking before the flip, one tach window
+#define REV_DWELL_MODE		REV_DWELL_COAST
+
+/**************Funtion Prototypes*****************/
+void reversal_init(void);
+int32_t reversal_step(int32_t stpt_rpm, u32 rpm_meas, u32 dt_us);
+int32_t reversal_signed_rpm(u32 rpm_meas);
+int32_t reversal_sign(void);
+u8 reversal_state(void);
+u8 reversal_dir_bit(void);
+bool reversal_bridge_enabled(void);
+
+#endif
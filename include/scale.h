@@ -0,0 +1,69 @@
+/****************************************************************************************
+*   @file scale.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Integer RPM <-> PWM scaling without a divide. The MicroBlaze has no
+*         hardware divider, so x * 255 / 6000 costs a library call every tick.
+*         Each ratio n / d is kept as a whole part and a 0.32 fraction
+*
+*             x * n / d = x * whole + (x * frac) >> 32
+*             whole = n / d,   frac = ceil(2^32 * (n % d) / d)
+*
+*         The rounded-up fraction is too large by less than d / 2^32, so the
+*         result equals the truncating division for every x < 2^32 / d. That
+*         covers |rpm| <= SCALE_RPM_IN_MAX for any full scale speed up to
+*         SCALE_RPM_IN_MAX. Negative inputs truncate toward zero, like C.
+*
+*         The ratios for SCALE_RPM_FULL are built at compile time with
+*         SCALE_RATIO(); scale_init() recomputes them for a measured full
+*         scale speed. The self-test checks every input in range against an
+*         exact reference that is stepped without dividing. It is split into
+*         slices of SCALE_TEST_SLICE inputs: scale_selftest_start() resets it
+*         and each scale_selftest_step() call checks one slice, so a caller
+*         running from a task does not hold up the scheduler.
+*
+*******************************************************************************************/
+#ifndef __SCALE_H__
+#define __SCALE_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+#include "xstatus.h"
+
+/*********** Constants **********/
+#define SCALE_PWM_FULL		255			// duty cycle count at full output
+#ifndef SCALE_RPM_FULL
+#define SCALE_RPM_FULL		6000		// speed at full output
+#endif
+
+#define SCALE_RPM_IN_MAX	65535		// largest |rpm| converted exactly, also the largest full scale
+#define SCALE_PWM_IN_MAX	32768		// largest |pwm| or encoder count converted exactly
+#define SCALE_TEST_SLICE	2048		// inputs checked per scale_selftest_step() call
+
+/*********** Macros **********/
+// x * n / d as a whole part and a rounded-up 0.32 fraction, for constants
+#define SCALE_WHOLE(n, d)	((u32)((n) / (d)))
+#define SCALE_FRAC(n, d)	((u32)((((u64)((n) % (d)) << 32) + (d) - 1) / (d)))
+#define SCALE_RATIO(n, d)	{ SCALE_WHOLE(n, d), SCALE_FRAC(n, d) }
+
+/*********** Type Definitions **********/
+typedef struct {
+	u32 whole;
+	u32 frac;
+} scale_ratio_t;
+
+/**************Funtion Prototypes*****************/
+XStatus scale_init(u32 full);
+u32 scale_rpm_full(void);
+
+int32_t scale_rpm_to_pwm(int32_t rpm);
+int32_t scale_pwm_to_rpm(int32_t pwm);
+
+void scale_selftest_start(void);
+bool scale_selftest_step(XStatus *result);
+
+#endif
@@ -0,0 +1,75 @@
+/****************************************************************************************
+*   @file scheduler.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Cooperative, static-table task scheduler. Each task has a period,
+*         a release offset, a priority (0 = highest) and an execution budget,
+*         all in microseconds. sched_dispatch() runs the highest priority task
+*         whose release time has passed and records per-task timing statistics.
+*         Tasks are never preempted, so a task that runs past its budget shows
+*         up as an overrun instead of silently stretching everyone else's period.
+*
+*         An interrupt handler can call sched_kick() to have a task run at the
+*         next dispatch without waiting for its release. A kicked run does not
+*         move the task's release grid.
+*
+*******************************************************************************************/
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define SCHED_MAX_TASKS		16
+#define SCHED_NO_TASK		0xFF
+
+/*********** Type Definitions **********/
+typedef void (*sched_fn_t)(void);
+typedef void (*sched_hook_t)(u8 id);
+
+// Per-task timing statistics
+typedef struct {
+	u32 runs;				// number of times the task was dispatched
+	u32 overruns;			// runs whose execution time exceeded the budget
+	u32 misses;				// releases dropped because the previous one had not run yet
+	u32 last_exec_us;		// execution time of the most recent run
+	u32 max_exec_us;		// worst execution time seen
+	u32 last_jitter_us;		// release-to-start latency of the most recent run
+	u32 max_jitter_us;		// worst release-to-start latency seen
+	u32 busy_ticks;			// timebase ticks spent in the task and post hook, wraps
+} sched_stats_t;
+
+// Static task descriptor. The application fills in the first six fields,
+// the remainder is scheduler state
+typedef struct {
+	const char *name;
+	sched_fn_t fn;
+	u32 period_us;
+	u32 offset_us;
+	u8 priority;
+	u32 budget_us;
+
+	u32 next_release_us;	// absolute time of the next release
+	sched_stats_t stats;
+} sched_task_t;
+
+/**************Funtion Prototypes*****************/
+void sched_init(sched_task_t *table, u8 ntasks);
+bool sched_dispatch(void);
+u32 sched_next_release_us(void);
+void sched_kick(u8 id);
+void sched_set_period(u8 id, u32 period_us);
+void sched_set_post_hook(sched_hook_t hook);
+u8 sched_current_task(void);
+u8 sched_num_tasks(void);
+const sched_task_t *sched_get_task(u8 id);
+const sched_stats_t *sched_get_stats(u8 id);
+void sched_reset_stats(void);
+void sched_report(void);
+
+#endif
@@ -0,0 +1,20 @@
+/****************************************************************************************
+*   @file sections.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Section placement attributes used with lscript.ld
+*
+*******************************************************************************************/
+#ifndef __SECTIONS_H__
+#define __SECTIONS_H__
+
+// Per-tick control path. Linked first in .text so it sits together at the bottom
+// of BRAM, within short branch range of itself and of the vectors
+#define HOT_CODE		__attribute__((section(".text.hot")))
+
+// Not cleared by the startup code, survives a watchdog reset
+#define NOINIT_DATA		__attribute__((section(".noinit")))
+
+#endif
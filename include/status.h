@@ -0,0 +1,47 @@
+/****************************************************************************************
+*   @file status.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Controller status on the RGB LEDs and the LED bar. The control tick
+*         stores its values in the snapshot returned by status_snapshot();
+*         status_render() runs from a slow task, works out what the LEDs should
+*         show and only writes the Nexys4IO registers whose value changed from
+*         the shadow copy.
+*
+*         LED[15:0]   PWM duty cycle as a bargraph
+*         RGB1        error magnitude: green small, yellow medium, red large,
+*                     blue added while the output is saturated
+*         RGB2        mode and fault state: blue SET, green RUN, cyan DIAG,
+*                     magenta CHAR, yellow DEGRADED, red ramp-down/stopped,
+*                     blinking red LATCHED
+*
+*******************************************************************************************/
+#ifndef __STATUS_H__
+#define __STATUS_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+
+/*********** Constants **********/
+#define STATUS_RGB_DC			0x40	// duty cycle of a lit RGB channel
+#define STATUS_ERR_SMALL		8		// |error| in PWM counts below which RGB1 is green
+#define STATUS_ERR_LARGE		32		// |error| from which RGB1 is red
+
+/*********** Type Definitions **********/
+// Written by the control tick
+typedef struct {
+	int16_t error;			// error in PWM counts
+	u8 pwm;					// duty cycle written to the bridge
+	bool saturated;			// controller output was clipped
+} status_snap_t;
+
+/**************Funtion Prototypes*****************/
+void status_init(void);
+status_snap_t *status_snapshot(void);
+void status_render(u8 mode);
+
+#endif
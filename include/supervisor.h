@@ -0,0 +1,58 @@
+/****************************************************************************************
+*   @file supervisor.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Watchdog supervisor. The timebase watchdog is only kicked while every
+*         armed critical channel (sampling, control, actuation) has checked in
+*         within its deadline. When a channel misses its deadline the H-bridge
+*         is forced to PWM = 0, the cause is recorded in memory that survives
+*         the reset, and the watchdog is left to expire. Until it does, the
+*         actuation paths check sup_actuation_allowed() and the safe state is
+*         re-applied on every sup_service() call, so a control task that is
+*         late but still running cannot drive the bridge again.
+*
+*******************************************************************************************/
+#ifndef __SUPERVISOR_H__
+#define __SUPERVISOR_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "xil_types.h"
+#include "xwdttb.h"
+
+/*********** Constants **********/
+// Critical channels that have to check in
+#define SUP_CH_SAMPLE		0
+#define SUP_CH_CONTROL		1
+#define SUP_CH_ACTUATE		2
+#define SUP_NUM_CH			3
+
+#define SUP_MASK(ch)		(1u << (ch))
+#define SUP_MASK_ALL		(SUP_MASK(SUP_CH_SAMPLE) | SUP_MASK(SUP_CH_CONTROL) | SUP_MASK(SUP_CH_ACTUATE))
+
+// Reset causes, as recorded across boots
+#define SUP_CAUSE_NONE			0	// no reset requested by the supervisor
+#define SUP_CAUSE_POWER_ON		1	// first boot after configuration / power up
+#define SUP_CAUSE_DEADLINE		2	// a critical channel missed its deadline
+#define SUP_CAUSE_USER			3	// reset requested by the application (CRASH mode)
+#define SUP_CAUSE_UNKNOWN		4	// reset while healthy: hang outside the supervisor or external reset
+
+/**************Funtion Prototypes*****************/
+void sup_init(XWdtTb *wdt);
+void sup_set_deadline(u8 ch, u32 deadline_us);
+void sup_arm(u8 mask);
+void sup_checkin(u8 ch);
+void sup_service(void);
+void sup_request_reset(u8 cause);
+void sup_safe_state(void);
+bool sup_actuation_allowed(void);
+
+u8 sup_reset_cause(void);
+u8 sup_failed_channel(void);
+u32 sup_boot_count(void);
+const char *sup_cause_str(u8 cause);
+
+#endif
@@ -60,19 +60,58 @@
 #define FIT_COUNT				(FIT_IN_CLOCK_FREQ_HZ / FIT_CLOCK_FREQ_HZ)
 #define FIT_COUNT_1MSEC			40
 
+// AXI timer used as the free-running system timebase
+#define TIMEBASE_DEVICE_ID		XPAR_TMRCTR_0_DEVICE_ID
+#define TIMEBASE_CLOCK_FREQ_HZ	XPAR_TMRCTR_0_CLOCK_FREQ_HZ
+#define TIMEBASE_TMR_NUM		0
+#define TIMEBASE_ALARM_TMR_NUM	1		// one-shot wake-up for the idle loop
+
+// Interrupt controller and the interrupt sources that wake the idle loop
+#define INTC_DEVICE_ID			XPAR_INTC_0_DEVICE_ID
+#define TIMEBASE_INTR_ID		XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_0_INTERRUPT_INTR
+#define UART_INTR_ID			XPAR_MICROBLAZE_0_AXI_INTC_AXI_UARTLITE_1_INTERRUPT_INTR
+
+// Watchdog supervisor: a critical channel that has not checked in for this long
+// stops the watchdog from being kicked. Channels checked in by the control task
+// get a few loop periods instead, with a floor for the longest task budget
+#define SUP_DEFAULT_DEADLINE_US	400000
+#define SUP_DEADLINE_PERIODS	3
+#define SUP_MIN_DEADLINE_US		50000
+
 // Application Specific
 #define NBTNS   5
 #define FACTOR_1	1
 #define FACTOR_5	5
 #define FACTOR_10	10
 #define GET_BIT(x,pos) (((x)  >> (pos)) & 0x1)
+// Gain scheduling: sw[12] takes the gains from the schedule, sw[11:9] selects the
+// breakpoint edited in SET mode
+#define SW_GS_ENABLE		12
+#define SW_GS_POINT(x)		(((x) >> 9) & 0x7)
+
 #define SET_MODE    0
 #define RUN_MODE    1
 #define CRASH_MODE  2
+#define DIAG_MODE   3
+#define CHAR_MODE   4		// open-loop motor characterization
+
+// Setpoint sources
+#define SP_SRC_ENCODER	0
+#define SP_SRC_CONSOLE	1
+#define SP_SRC_STREAM	2		// profile streamed over the console
+
+// Default limits, adjustable from the console
+#define RPM_LIMIT_DEFAULT	5000
+#define PWM_LIMIT_DEFAULT	200
+
+// Output ramp once RUN mode is left, in PWM counts per second
+#define RELEASE_RAMP_PWM_PER_S	500
 
 // Peripheral Instances
 extern XIntc   IntCtlrInst;             // Interrupt Controller instance
 extern XUartLite uart;       // UARTlite instance
+extern PMODHB3 HB3_Inst;     // H-bridge instance
+extern PMODENC544 ENC_Inst;  // rotary encoder instance
 extern u16 kpid[3];
 extern volatile u16 stptRPM;
 
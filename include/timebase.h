@@ -0,0 +1,44 @@
+/****************************************************************************************
+*   @file timebase.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Free-running microsecond timebase used by the scheduler and the
+*         controller. On the target it is derived from the AXI timer running
+*         in free-running (auto-reload, count-up) mode. When HOST_BUILD is
+*         defined the timebase is a virtual clock that only moves when
+*         timebase_advance_us() is called, which the
+*         host tests in test/ use to run the scheduler on a repeatable clock.
+*
+*         The second counter of the AXI timer is a one-shot alarm that raises
+*         the timer interrupt, so the idle loop can sleep until the next task
+*         release. timebase_isr() is the handler for that interrupt.
+*
+*******************************************************************************************/
+#ifndef __TIMEBASE_H__
+#define __TIMEBASE_H__
+
+/******************Header files***************************/
+#include <stdint.h>
+#include "xil_types.h"
+#include "xstatus.h"
+
+/*********** Constants **********/
+#define TIMEBASE_US_PER_MS		1000u
+#define TIMEBASE_US_PER_SEC		1000000u
+#define TIMEBASE_ALARM_MAX_US	1000000u
+
+/**************Funtion Prototypes*****************/
+XStatus timebase_init(void);
+u32 timebase_now_us(void);
+u32 timebase_now_ticks(void);
+u32 timebase_ticks_per_us(void);
+void timebase_set_alarm_us(u32 us);
+void timebase_isr(void *ref);
+
+#ifdef HOST_BUILD
+void timebase_advance_us(u32 us);
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+# footprint.sh - memory footprint report for the MicroBlaze ELF
+#
+# usage: footprint.sh <elf> [number of symbols]
+#
+# Prints the size of every allocated section, the BRAM left over, the size of
+# the hot control path and the largest symbols. Add it as a post-build step in
+# the SDK project (C/C++ Build -> Settings -> Build Steps) with
+#     sh ../scripts/footprint.sh ${ProjName}.elf
+#
+# Set CROSS to use a different toolchain prefix (default mb-).
+
+ELF=$1
+NSYMS=${2:-25}
+CROSS=${CROSS-mb-}
+BRAM_SIZE=131072
+
+if [ -z "$ELF" ] || [ ! -f "$ELF" ]; then
+	echo "usage: $0 <elf> [number of symbols]" >&2
+	exit 1
+fi
+
+echo "==== Sections ===="
+${CROSS}size -A -d "$ELF" | awk '
+	$1 ~ /^\./ && $3 != "" { printf "%-20s %8d\n", $1, $2 }'
+
+echo
+echo "==== BRAM usage ===="
+${CROSS}nm -t d "$ELF" | awk -v bram=$BRAM_SIZE '
+	$3 == "_end"             { end = $1 + 0 }
+	$3 == "__text_hot_start" { hs = $1 + 0 }
+	$3 == "__text_hot_end"   { he = $1 + 0 }
+	$3 == "_stack_end"       { ss = $1 + 0 }
+	$3 == "_stack"           { se = $1 + 0 }
+	$3 == "_heap_start"      { hps = $1 + 0 }
+	$3 == "_heap_end"        { hpe = $1 + 0 }
+	END {
+		printf "used      %8d of %d bytes (%d%%)\n", end, bram, end * 100 / bram
+		printf "free      %8d bytes\n", bram - end
+		printf "hot code  %8d bytes\n", he - hs
+		printf "stack     %8d bytes\n", se - ss
+		printf "heap      %8d bytes\n", hpe - hps
+	}'
+
+echo
+echo "==== Largest $NSYMS symbols ===="
+${CROSS}nm -t d -S --size-sort -r -C "$ELF" | head -n "$NSYMS" | awk '
+	{ printf "%8d %s %s\n", $2, $3, $4 }'
+
+echo
+echo "==== Floating point / libm helpers pulled in ===="
+${CROSS}nm "$ELF" | awk '
+	$3 ~ /^__(add|sub|mul|div|fix|float|extend|trunc|cmp|eq|ne|lt|le|gt|ge)[sd]f/ ||
+	$3 ~ /^(fmin|fmax|floor|ceil|sqrt|pow|exp|log)f?$/ { print "  " $3; n++ }
+	END { if (n == 0) print "  none" }'
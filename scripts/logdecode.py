@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+#
+# logdecode.py - formats deferred log records (LOG_DEFERRED=1)
+#
+# usage: logdecode.py <elf> [capture file]
+#
+# Reads LOG,<header>,<time>,<args...> lines from the capture file (or stdin),
+# looks the format string up in the .logstr section of the ELF and prints the
+# formatted message. Other lines are passed through unchanged.
+#
+# Set CROSS to use a different toolchain prefix (default mb-).
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+LEVELS = {1: "ERR", 2: "WARN", 3: "INFO", 4: "DEBUG"}
+SPEC = re.compile(r"%[-0 #+]*\d*l?([diuxXc%])")
+
+
+def load_strings(elf):
+    cross = os.environ.get("CROSS", "mb-")
+    with tempfile.NamedTemporaryFile() as out:
+        subprocess.check_call([cross + "objcopy", "-O", "binary", "--only-section=.logstr",
+                               "--set-section-flags", ".logstr=alloc", elf, out.name])
+        return out.read()
+
+
+def fmt_string(strs, sid):
+    end = strs.index(b"\0", sid)
+    return strs[sid:end].decode("latin-1")
+
+
+def format_msg(fmt, args):
+    args = list(args)
+
+    def conv(m):
+        kind = m.group(1)
+        if kind == "%":
+            return "%"
+        v = args.pop(0) if args else 0
+        spec = m.group(0).replace("l", "")
+        if kind in "di":
+            v = v - (1 << 32) if v & 0x80000000 else v
+            spec = spec[:-1] + "d"
+        elif kind == "u":
+            spec = spec[:-1] + "d"
+        return spec % v
+
+    return SPEC.sub(conv, fmt)
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit("usage: %s <elf> [capture file]" % sys.argv[0])
+
+    strs = load_strings(sys.argv[1])
+    src = open(sys.argv[2]) if len(sys.argv) > 2 else sys.stdin
+    last_seq = None
+
+    for line in src:
+        line = line.rstrip("\r\n")
+        if not line.startswith("LOG,"):
+            print(line)
+            continue
+
+        words = [int(w, 16) for w in line.split(",")[1:]]
+        hdr, t, args = words[0], words[1], words[2:]
+        sid, level, seq = hdr & 0xFFFF, (hdr >> 19) & 0x7, hdr >> 24
+
+        if last_seq is not None and seq != (last_seq + 1) & 0xFF:
+            print("-- %d record(s) dropped --" % ((seq - last_seq - 1) & 0xFF))
+        last_seq = seq
+
+        msg = format_msg(fmt_string(strs, sid), args).rstrip("\r\n").lstrip("\r\n")
+        print("%10.6f %-5s %s" % (t / 1e6, LEVELS.get(level, "?"), msg))
+
+
+if __name__ == "__main__":
+    main()
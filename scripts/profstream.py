@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+#
+# profstream.py - streams a setpoint profile to the board (see include/profile.h)
+#
+# usage: profstream.py <serial port> <profile csv>
+#
+# The CSV has one <time ms>,<rpm> point per line, times absolute and rising,
+# lines starting with # are skipped. Points have to be less than 65535 ms
+# apart; a dt of 65535 is the end marker on the board. RPM must fit in 16 bits
+# signed. The points are sent as "pt <dt> <rpm>" console lines followed by the
+# end marker, and "play" starts the playback.
+# A point the board answers with FULL is sent again after a short wait, so the
+# board's free-slot replies pace the stream. ERR, or no reply for
+# SILENT_READS serial timeouts, aborts.
+#
+# Needs pyserial.
+
+import sys
+import time
+
+import serial
+
+END_DT = 0xFFFF
+RPM_MIN, RPM_MAX = -32768, 32767
+RETRY_S = 0.05
+SILENT_READS = 5
+
+
+def load(path):
+    points, last = [], 0
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            t, rpm = (int(v) for v in line.split(","))
+            if not 0 <= t - last < END_DT:
+                raise ValueError("%s: point at %d ms is not 0 to %d ms after the previous one"
+                                 % (path, t, END_DT - 1))
+            if not RPM_MIN <= rpm <= RPM_MAX:
+                raise ValueError("%s: %d rpm at %d ms is outside %d to %d"
+                                 % (path, rpm, t, RPM_MIN, RPM_MAX))
+            points.append((t - last, rpm))
+            last = t
+    return points
+
+
+def reply_to(port, line):
+    silent = 0
+    while silent < SILENT_READS:
+        reply = port.readline().decode("latin-1").strip()
+        if not reply:
+            silent += 1
+        elif reply.split()[0] in ("OK", "FULL", "ERR"):
+            return reply
+    raise RuntimeError("no reply to %r" % line)
+
+
+def send(port, dt, rpm):
+    line = "pt %d %d" % (dt, rpm)
+    while True:
+        port.write((line + "\r").encode())
+        reply = reply_to(port, line).split()
+        if reply[0] == "OK":
+            return int(reply[1])
+        if reply[0] == "ERR":
+            raise RuntimeError("board refused %r" % line)
+        time.sleep(RETRY_S)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: profstream.py <serial port> <profile csv>")
+
+    points = load(sys.argv[2])
+    with serial.Serial(sys.argv[1], 115200, timeout=1) as port:
+        port.write(b"play\r")
+        for dt, rpm in points:
+            free = send(port, dt, rpm)
+            print("pt %d %d, %d free" % (dt, rpm, free))
+        send(port, END_DT, 0)
+        print("end queued")
+
+
+if __name__ == "__main__":
+    main()
@@ -5,55 +5,122 @@
 #include "xil_types.h"
 #include "xparameters.h"
 #include "xil_io.h"
-
-/***************************** Global variables ****************************/
-static u32 baseAddress = 0L;
-static bool isInitialized = false;
+#include "timebase.h"
 
 /************************** Function Definitions ***************************/
 
-XStatus PMODHB3_Initialize(u32 baseaddr_p)
+/**
+ *
+ * Sets up a PMODHB3 instance.
+ *
+ * @param   InstancePtr is the instance to set up.
+ * @param   baseaddr_p is the base address of the PMODHB3 peripheral.
+ *
+ * @return  XST_SUCCESS, or XST_FAILURE if the base address is not valid.
+ *
+ */
+XStatus PMODHB3_Initialize(PMODHB3 *InstancePtr, u32 baseaddr_p)
 {
-    //XStatus sts;
-    if (baseaddr_p == NULL) {
-        isInitialized = false;
-        return XST_FAILURE;  
-    }
-    
-    if (isInitialized) {
-        return XST_SUCCESS;
-    }
-    else {
-        baseAddress = baseaddr_p;
-        //sts = PMODHB3_AXI_IP_Reg_SelfTest(baseAddress);
-        //if (sts != XST_SUCCESS)
-        //    return XST_FAILURE;
-        
-        isInitialized = true;
-    }
-    return XST_SUCCESS; 
+    if (AXI_Periph_Init(&InstancePtr->io, baseaddr_p) != XST_SUCCESS)
+        return XST_FAILURE;
+
+#ifdef HOST_BUILD
+    AXI_Periph_AttachSim(&InstancePtr->io, PMODHB3_Sim_Read, PMODHB3_Sim_Write);
+#endif
+
+    InstancePtr->hasCounter = false;
+    InstancePtr->lastCount = AXI_Periph_Read(&InstancePtr->io, PMODHB3_COUNT_OFFSET);
+    InstancePtr->lastRpm = AXI_Periph_Read(&InstancePtr->io, PMODHB3_RPM_OFFSET);
+    InstancePtr->lastFreshUs = 0;       // the timebase may not be running yet
+
+    return XST_SUCCESS;
 }
 
-u32 PMODHB3_GetRpm(u32 baseAddress, u32 offset)
+/**
+ *
+ * Checks for a tach measurement that has not been seen yet.
+ *
+ * The counter is read first and again after the RPM and timestamp, and the read
+ * is repeated if a window closed in between, so the three values always belong
+ * to the same measurement.
+ *
+ * @param   InstancePtr is the PMODHB3 instance.
+ * @param   sample is filled with the latest measurement, new or not.
+ *
+ * @return  true if the measurement is new since the previous call.
+ *
+ */
+bool PMODHB3_PollNewSample(PMODHB3 *InstancePtr, PMODHB3_Sample *sample)
 {
-    if(isInitialized)
-    {
-        return PMODHB3_IP_mReadReg(baseAddress, offset);
+    const AXI_Periph *io = &InstancePtr->io;
+    u32 count;
+
+    do {
+        count = AXI_Periph_Read(io, PMODHB3_COUNT_OFFSET);
+        sample->rpm = AXI_Periph_Read(io, PMODHB3_RPM_OFFSET);
+        sample->timestamp = AXI_Periph_Read(io, PMODHB3_STAMP_OFFSET);
+    } while (count != AXI_Periph_Read(io, PMODHB3_COUNT_OFFSET));
+
+    sample->count = count;
+
+    if (count != InstancePtr->lastCount) {
+        InstancePtr->hasCounter = true;
+        InstancePtr->lastCount = count;
+        InstancePtr->lastRpm = sample->rpm;
+        return true;
     }
-    else
-    {
-        return 0xFFFFFFFF;
+
+    if (InstancePtr->hasCounter)
+        return false;
+
+    // No sample counter in this bitstream: fall back on the reading and the window length
+    u32 now = timebase_now_us();
+    if (sample->rpm != InstancePtr->lastRpm || now - InstancePtr->lastFreshUs >= PMODHB3_TACH_WINDOW_US) {
+        InstancePtr->lastRpm = sample->rpm;
+        InstancePtr->lastFreshUs = now;
+        return true;
     }
+
+    return false;
 }
 
-XStatus PMODHB3_SetConfig(u32 baseAddress, u32 offset, u32 data)
+/**
+ *
+ * Waits for the next tach measurement.
+ *
+ * @param   InstancePtr is the PMODHB3 instance.
+ * @param   sample is filled with the new measurement.
+ * @param   timeout_us is the longest time to wait.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if a new measurement arrived
+ *    - XST_FAILURE   on a timeout
+ *
+ */
+XStatus PMODHB3_WaitForNewSample(PMODHB3 *InstancePtr, PMODHB3_Sample *sample, u32 timeout_us)
 {
+    u32 start = timebase_now_us();
 
-    if(isInitialized)
-    {
-        PMODHB3_IP_mWriteReg(baseAddress, offset, data);
-        return XST_SUCCESS;
+    while (!PMODHB3_PollNewSample(InstancePtr, sample)) {
+        if (timebase_now_us() - start >= timeout_us)
+            return XST_FAILURE;
+#ifdef HOST_BUILD
+        // the virtual clock only moves when told to
+        timebase_advance_us(1);
+#endif
     }
-    
-    return XST_FAILURE;
+
+    return XST_SUCCESS;
+}
+
+/**
+ *
+ * Returns true once the hardware sample counter (REG2) has been seen to move.
+ * Until then new measurements are detected from the RPM reading and the window length.
+ *
+ */
+bool PMODHB3_HasSampleCounter(const PMODHB3 *InstancePtr)
+{
+    return InstancePtr->hasCounter;
 }
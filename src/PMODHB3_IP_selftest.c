@@ -9,6 +9,10 @@
 /************************** Constant Definitions ***************************/
 #define READ_WRITE_MUL_FACTOR 0x10
 
+// Only REG0 and REG1 are tested. REG2 and REG3 are the tach sample counter and
+// timestamp: a write there would look like a new sample to PMODHB3_PollNewSample()
+#define SELFTEST_NUM_REGS 2
+
 /************************** Function Definitions ***************************/
 /**
  *
@@ -46,11 +50,11 @@ XStatus PMODHB3_IP_Reg_SelfTest(u32 baseaddr_p)
 	 */
 	xil_printf("User logic slave module test...\n\r");
 
-	for (write_loop_index = 0 ; write_loop_index < 4; write_loop_index++){
+	for (write_loop_index = 0 ; write_loop_index < SELFTEST_NUM_REGS; write_loop_index++){
 	  PMODHB3_IP_mWriteReg (baseaddr, write_loop_index*4, (write_loop_index+1)*READ_WRITE_MUL_FACTOR);
 	  xil_printf("Write: %u\n\r", (write_loop_index+1)*READ_WRITE_MUL_FACTOR);
 	}
-	for (read_loop_index = 0 ; read_loop_index < 4; read_loop_index++){
+	for (read_loop_index = 0 ; read_loop_index < SELFTEST_NUM_REGS; read_loop_index++){
 		xil_printf("Read: %u\n\r", PMODHB3_IP_mReadReg (baseaddr, read_loop_index*4));
 	  if ( PMODHB3_IP_mReadReg (baseaddr, read_loop_index*4) != (u32)(read_loop_index+1)*READ_WRITE_MUL_FACTOR){
 	    xil_printf ("Error reading register value at address %x\n", (u32)baseaddr + read_loop_index*4);
@@ -0,0 +1,159 @@
+
+/***************************** Include Files *******************************/
+#include "PMODHB3_IP.h"
+#include "timebase.h"
+
+#ifdef HOST_BUILD
+
+/**
+ * Simulated PMODHB3 register model for host builds.
+ *
+ * The register accessors in PMODHB3_IP.h call into this model when HOST_BUILD
+ * is defined. A first-order motor is driven by REG1 and integrated against the
+ * virtual timebase every time a register is accessed. Every
+ * PMODHB3_TACH_WINDOW_US the average speed over the window is latched into
+ * REG0, REG2 is incremented and REG3 gets the clock count of the window end,
+ * the same as the hardware. PMODHB3_Sim_Reset(base, false) models a bitstream
+ * without the sample counter. PMODHB3_Sim_SetReadDelay() makes every register
+ * read take time, so a window can close between two reads of one sample.
+ */
+
+/************************** Constant Definitions ***************************/
+#define SIM_STEP_US             100         // model integration step
+#define SIM_DEFAULT_MAX_RPM     6000        // speed at full duty cycle
+#define SIM_DEFAULT_TAU_US      150000
+
+/***************************** Global variables ****************************/
+static u32 simBase = 0;
+static u32 reg[4];
+static bool simCounter = true;
+
+static u32 maxRpm = SIM_DEFAULT_MAX_RPM;
+static u32 tauUs = SIM_DEFAULT_TAU_US;
+static u8 deadband = 0;                    // duty cycle below which the motor does not turn
+static u32 readDelayUs = 0;                // virtual time each register read takes
+static int32_t speedQ8 = 0;                // motor speed, Q8 RPM, always positive
+static u32 modelUs = 0;                    // time the model has been run up to
+static u32 windowStartUs = 0;
+static int64_t windowSum = 0;              // integral of the speed over the window
+
+/************************** Function Definitions ***************************/
+/**
+ *
+ * Runs the motor model up to the current virtual time.
+ *
+ */
+static void PMODHB3_Sim_Advance(void)
+{
+    u32 now = timebase_now_us();
+
+    while (now - modelUs >= SIM_STEP_US) {
+        bool enabled = (reg[1] >> 9) & 0x1;
+        u32 duty = reg[1] & 0xFF;
+        int32_t targetQ8 = (enabled && duty > deadband) ?
+                           (int32_t)((duty - deadband) * maxRpm * 256 / (255 - deadband)) : 0;
+
+        speedQ8 += (int32_t)((int64_t)(targetQ8 - speedQ8) * SIM_STEP_US / tauUs);
+        modelUs += SIM_STEP_US;
+        windowSum += speedQ8;
+
+        if (modelUs - windowStartUs >= PMODHB3_TACH_WINDOW_US) {
+            reg[0] = (u32)((windowSum / (PMODHB3_TACH_WINDOW_US / SIM_STEP_US)) >> 8);
+            if (simCounter) {
+                reg[2]++;
+                reg[3] = modelUs * timebase_ticks_per_us();
+            }
+            windowSum = 0;
+            windowStartUs = modelUs;
+        }
+    }
+}
+
+/**
+ *
+ * Resets the model: motor stopped, all registers zero.
+ *
+ * @param   baseAddress is the base address the driver will be initialized with.
+ * @param   hasCounter is false to model a bitstream without REG2/REG3.
+ *
+ */
+void PMODHB3_Sim_Reset(u32 baseAddress, bool hasCounter)
+{
+    simBase = baseAddress;
+    simCounter = hasCounter;
+
+    for (u8 i = 0; i < 4; i++)
+        reg[i] = 0;
+
+    speedQ8 = 0;
+    modelUs = timebase_now_us();
+    windowStartUs = modelUs;
+    windowSum = 0;
+}
+
+/**
+ *
+ * Sets the simulated motor.
+ *
+ * @param   maxRpm_p is the speed at full duty cycle.
+ * @param   tau_us is the mechanical time constant.
+ *
+ */
+void PMODHB3_Sim_SetMotor(u32 maxRpm_p, u32 tau_us)
+{
+    maxRpm = maxRpm_p;
+    tauUs = (tau_us > 0) ? tau_us : 1;
+}
+
+/**
+ *
+ * Sets the duty cycle the simulated motor needs before it turns. Full speed
+ * is still reached at full duty cycle.
+ *
+ * @param   duty is the deadband, 0 to 254.
+ *
+ */
+void PMODHB3_Sim_SetDeadband(u8 duty)
+{
+    deadband = (duty < 255) ? duty : 254;
+}
+
+/**
+ *
+ * Sets the virtual time every register read takes.
+ *
+ * @param   us is the delay, 0 for reads that take no time.
+ *
+ */
+void PMODHB3_Sim_SetReadDelay(u32 us)
+{
+    readDelayUs = us;
+}
+
+/**
+ *
+ * Register read.
+ *
+ */
+u32 PMODHB3_Sim_Read(u32 addr)
+{
+    if (readDelayUs > 0)
+        timebase_advance_us(readDelayUs);
+
+    PMODHB3_Sim_Advance();
+    return reg[((addr - simBase) >> 2) & 0x3];
+}
+
+/**
+ *
+ * Register write. Only REG1 is writable, the others are status registers.
+ *
+ */
+void PMODHB3_Sim_Write(u32 addr, u32 data)
+{
+    PMODHB3_Sim_Advance();
+    if (((addr - simBase) >> 2) == 1)
+        reg[1] = data & 0x3FF;
+}
+
+#endif
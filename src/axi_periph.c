@@ -0,0 +1,64 @@
+
+/***************************** Include Files *******************************/
+#include "axi_periph.h"
+
+#ifdef HOST_BUILD
+/***************************** Global variables ****************************/
+// Default host register file, shared by every handle without a model and
+// indexed by the word address
+static u32 simRegs[AXI_PERIPH_SIM_REGS];
+
+/************************** Function Definitions ***************************/
+static u32 AXI_Periph_RamRead(u32 addr)
+{
+    return simRegs[(addr >> 2) % AXI_PERIPH_SIM_REGS];
+}
+
+static void AXI_Periph_RamWrite(u32 addr, u32 data)
+{
+    simRegs[(addr >> 2) % AXI_PERIPH_SIM_REGS] = data;
+}
+#endif
+
+/**
+ *
+ * Sets up a peripheral handle.
+ *
+ * @param   periph is the handle to set up.
+ * @param   baseaddr_p is the base address of the peripheral.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if the handle can be used
+ *    - XST_FAILURE   if the base address is 0
+ *
+ */
+XStatus AXI_Periph_Init(AXI_Periph *periph, UINTPTR baseaddr_p)
+{
+    if (baseaddr_p == 0)
+        return XST_FAILURE;
+
+    periph->base = baseaddr_p;
+#ifdef HOST_BUILD
+    periph->simRead = AXI_Periph_RamRead;
+    periph->simWrite = AXI_Periph_RamWrite;
+#endif
+    return XST_SUCCESS;
+}
+
+#ifdef HOST_BUILD
+/**
+ *
+ * Routes a host handle to a register model.
+ *
+ * @param   periph is a handle set up by AXI_Periph_Init().
+ * @param   rd is called for every register read with the full address.
+ * @param   wr is called for every register write with the full address.
+ *
+ */
+void AXI_Periph_AttachSim(AXI_Periph *periph, AXI_SimRead rd, AXI_SimWrite wr)
+{
+    periph->simRead = rd;
+    periph->simWrite = wr;
+}
+#endif
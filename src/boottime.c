@@ -0,0 +1,79 @@
+/****************************************************************************************
+*   @file boottime.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Boot sequence timing. See boottime.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "boottime.h"
+#include "timebase.h"
+#include "xil_printf.h"
+
+/***************************** Global variables ****************************/
+static const char *step_name[BOOT_MAX_STEPS];
+static u32 step_us[BOOT_MAX_STEPS];
+static u8 num_steps = 0;
+static u32 last_mark_us = 0;
+static u32 first_tick_us = 0;
+static bool ticked = false;
+
+/************************** Function Definitions ***************************/
+/**
+ * Records the time taken since the previous mark, or since the timebase started
+ *
+ * @param   step    name of the step that just finished
+ *
+ */
+void boot_mark(const char *step)
+{
+	u32 now = timebase_now_us();
+
+	if (num_steps < BOOT_MAX_STEPS) {
+		step_name[num_steps] = step;
+		step_us[num_steps] = now - last_mark_us;
+		num_steps++;
+	}
+
+	last_mark_us = now;
+}
+
+
+/**
+ * Records the time of the first control tick. Only the first call counts
+ *
+ */
+void boot_first_tick(void)
+{
+	if (!ticked) {
+		first_tick_us = timebase_now_us();
+		ticked = true;
+	}
+}
+
+
+/**
+ * Returns the time from the timebase starting to the first control tick, 0 until it ran
+ *
+ */
+u32 boot_first_tick_us(void)
+{
+	return first_tick_us;
+}
+
+
+/**
+ * Prints the step times over the UART
+ *
+ */
+void boot_report(void)
+{
+	for (u8 i = 0; i < num_steps; i++)
+		xil_printf("BOOT,%s,%u\r\n", step_name[i], step_us[i]);
+
+	if (ticked)
+		xil_printf("BOOT,first_tick,%u\r\n", first_tick_us);
+}
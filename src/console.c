@@ -0,0 +1,493 @@
+/****************************************************************************************
+*   @file console.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Non-blocking UART command console. See console.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include <string.h>
+#include "console.h"
+#include "xparameters.h"
+#include "xuartlite_l.h"
+#include "timebase.h"
+
+/************************** Constant Definitions ***************************/
+#define CONSOLE_BIN_FRAME_LEN	8		// request length including the sync byte
+#define CONSOLE_MAX_TOKENS		3
+#define CONSOLE_FRAME_GAP_US	5000	// quiet time that drops a partial binary frame
+#define CONSOLE_TX_MASK			(CONSOLE_TX_LEN - 1)
+
+_Static_assert((CONSOLE_TX_LEN & CONSOLE_TX_MASK) == 0, "CONSOLE_TX_LEN must be a power of 2");
+
+// Parser states
+#define PARSE_TEXT				0
+#define PARSE_BINARY			1
+
+/***************************** Global variables ****************************/
+static XUartLite *uart_p = NULL;
+static const console_param_t *param_tbl = NULL;
+static u8 num_params = 0;
+static const console_cmd_t *cmd_tbl = NULL;
+static u8 num_cmds = 0;
+static console_stream_fn stream_fn = NULL;
+
+static u8 parse_state = PARSE_TEXT;
+static char line[CONSOLE_LINE_LEN];
+static u8 line_len = 0;
+static bool line_overflow = false;
+static u8 frame[CONSOLE_BIN_FRAME_LEN];
+static u8 frame_len = 0;
+static u32 frame_us = 0;				// when the last byte of the frame was parsed
+
+static u8 tx_ring[CONSOLE_TX_LEN];
+static u16 tx_head = 0;				// next byte to queue
+static u16 tx_tail = 0;				// next byte to send
+
+/************************** Function Definitions ***************************/
+/**
+ * Moves queued bytes to the transmit FIFO until it is full or the ring is empty
+ *
+ */
+static void console_tx_drain(void)
+{
+	UINTPTR base = uart_p->RegBaseAddress;
+
+	while (tx_tail != tx_head && !XUartLite_IsTransmitFull(base)) {
+		XUartLite_WriteReg(base, XUL_TX_FIFO_OFFSET, tx_ring[tx_tail]);
+		tx_tail = (tx_tail + 1) & CONSOLE_TX_MASK;
+	}
+}
+
+
+/**
+ * Queues one character for console_task() to send. Before console_init() the
+ * character is sent directly. When the ring is full the oldest byte is sent
+ * first, waiting for room in the transmit FIFO
+ *
+ */
+void console_putc(char c)
+{
+	if (uart_p == NULL) {
+		XUartLite_SendByte(STDOUT_BASEADDRESS, (u8)c);
+		return;
+	}
+
+	u16 next = (tx_head + 1) & CONSOLE_TX_MASK;
+	while (next == tx_tail)
+		console_tx_drain();
+
+	tx_ring[tx_head] = (u8)c;
+	tx_head = next;
+}
+
+
+/**
+ * Replaces the BSP's outbyte(), so xil_printf() output goes through the
+ * transmit ring as well
+ *
+ */
+void outbyte(char c)
+{
+	console_putc(c);
+}
+
+
+/**
+ * Writes a string
+ *
+ */
+void console_puts(const char *s)
+{
+	while (*s)
+		console_putc(*s++);
+}
+
+
+/**
+ * Writes a signed decimal number
+ *
+ */
+void console_putint(int32_t v)
+{
+	char buf[12];
+	u8 n = 0;
+	u32 uv;
+
+	if (v < 0) {
+		console_putc('-');
+		uv = -(u32)v;
+	}
+	else {
+		uv = v;
+	}
+
+	do {
+		buf[n++] = '0' + (uv % 10);
+		uv /= 10;
+	} while (uv);
+
+	while (n)
+		console_putc(buf[--n]);
+}
+
+
+/**
+ * Reads a parameter, sign extending it to 32 bits
+ *
+ */
+static int32_t param_read(const console_param_t *p)
+{
+	switch (p->size) {
+		case 1:
+			return p->is_signed ? *(volatile int8_t *)p->ptr : *(volatile u8 *)p->ptr;
+		case 2:
+			return p->is_signed ? *(volatile int16_t *)p->ptr : *(volatile u16 *)p->ptr;
+		default:
+			return *(volatile int32_t *)p->ptr;
+	}
+}
+
+
+/**
+ * Range checks and writes a parameter, then runs its on_set hook
+ *
+ * @return  true if the value was written
+ *
+ */
+static bool param_write(const console_param_t *p, int32_t v)
+{
+	if (v < p->min || v > p->max)
+		return false;
+
+	switch (p->size) {
+		case 1:
+			*(volatile u8 *)p->ptr = (u8)v;
+			break;
+		case 2:
+			*(volatile u16 *)p->ptr = (u16)v;
+			break;
+		default:
+			*(volatile int32_t *)p->ptr = v;
+			break;
+	}
+
+	if (p->on_set)
+		p->on_set();
+
+	return true;
+}
+
+
+/**
+ * Looks up a parameter by name
+ *
+ */
+static const console_param_t *param_find(const char *name)
+{
+	for (u8 i = 0; i < num_params; i++) {
+		if (strcmp(param_tbl[i].name, name) == 0)
+			return &param_tbl[i];
+	}
+	return NULL;
+}
+
+
+/**
+ * Parses a signed decimal number
+ *
+ * @return  true if the whole string was a valid number that fits in 32 bits
+ *
+ */
+static bool parse_int(const char *s, int32_t *out)
+{
+	bool neg = false;
+	u32 v = 0;
+
+	if (*s == '-') {
+		neg = true;
+		s++;
+	}
+
+	if (*s == '\0')
+		return false;
+
+	// magnitude of the most negative or most positive value
+	u32 lim = neg ? (u32)INT32_MAX + 1 : (u32)INT32_MAX;
+
+	while (*s) {
+		if (*s < '0' || *s > '9')
+			return false;
+
+		u32 d = *s++ - '0';
+		if (v > (lim - d) / 10)
+			return false;
+		v = v * 10 + d;
+	}
+
+	*out = neg ? (int32_t)(0u - v) : (int32_t)v;
+	return true;
+}
+
+
+/**
+ * Prints one parameter as name=value
+ *
+ */
+static void print_param(const console_param_t *p)
+{
+	console_puts(p->name);
+	console_putc('=');
+	console_putint(param_read(p));
+	console_puts("\r\n");
+}
+
+
+/**
+ * Executes one complete text line
+ *
+ */
+static void exec_line(void)
+{
+	char *tok[CONSOLE_MAX_TOKENS];
+	u8 ntok = 0;
+	char *p = line;
+
+	// split on spaces in place
+	while (*p) {
+		while (*p == ' ')
+			*p++ = '\0';
+		if (*p == '\0')
+			break;
+		if (ntok == CONSOLE_MAX_TOKENS) {
+			// no command takes this many arguments
+			console_puts("ERR\r\n");
+			return;
+		}
+		tok[ntok++] = p;
+		while (*p && *p != ' ')
+			p++;
+	}
+
+	if (ntok == 0)
+		return;
+
+	if (strcmp(tok[0], "get") == 0 && ntok == 2) {
+		const console_param_t *prm = param_find(tok[1]);
+		if (prm) {
+			print_param(prm);
+			return;
+		}
+	}
+	else if (strcmp(tok[0], "set") == 0 && ntok == 3) {
+		const console_param_t *prm = param_find(tok[1]);
+		int32_t v;
+		if (prm && parse_int(tok[2], &v) && param_write(prm, v)) {
+			console_puts("OK\r\n");
+			return;
+		}
+	}
+	else if (strcmp(tok[0], "pt") == 0 && ntok == 3 && stream_fn) {
+		int32_t dt, rpm, reply;
+		if (parse_int(tok[1], &dt) && dt >= 0 && dt <= 0xFFFF &&
+			parse_int(tok[2], &rpm) && rpm >= INT16_MIN && rpm <= INT16_MAX) {
+			u8 status = stream_fn(0, (u32)dt << 16 | (u16)rpm, &reply);
+			// a full queue is not an error, the host resends the point
+			if (status == CONSOLE_BIN_OK || status == CONSOLE_BIN_ERR_FULL) {
+				console_puts((status == CONSOLE_BIN_OK) ? "OK " : "FULL ");
+				console_putint(reply);
+				console_puts("\r\n");
+				return;
+			}
+		}
+	}
+	else if (strcmp(tok[0], "list") == 0 && ntok == 1) {
+		for (u8 i = 0; i < num_params; i++)
+			print_param(&param_tbl[i]);
+		return;
+	}
+	else if (ntok == 1) {
+		for (u8 i = 0; i < num_cmds; i++) {
+			if (strcmp(cmd_tbl[i].name, tok[0]) == 0) {
+				cmd_tbl[i].fn();
+				return;
+			}
+		}
+	}
+
+	console_puts("ERR\r\n");
+}
+
+
+/**
+ * Executes one complete binary frame and sends the reply
+ *
+ */
+static void exec_frame(void)
+{
+	u8 cmd = frame[1];
+	u8 id = frame[2];
+	u8 chk = 0;
+	u8 status = CONSOLE_BIN_OK;
+	int32_t v = 0;
+
+	for (u8 i = 1; i < CONSOLE_BIN_FRAME_LEN - 1; i++)
+		chk ^= frame[i];
+
+	if (chk != frame[CONSOLE_BIN_FRAME_LEN - 1]) {
+		status = CONSOLE_BIN_ERR_CHK;
+	}
+	else if (cmd == CONSOLE_BIN_STREAM) {
+		v = (int32_t)((u32)frame[3] | (u32)frame[4] << 8 | (u32)frame[5] << 16 | (u32)frame[6] << 24);
+		if (stream_fn)
+			status = stream_fn(id, (u32)v, &v);
+		else
+			status = CONSOLE_BIN_ERR_CMD;
+	}
+	else if (id >= num_params) {
+		status = CONSOLE_BIN_ERR_ID;
+	}
+	else if (cmd == CONSOLE_BIN_SET) {
+		v = (int32_t)((u32)frame[3] | (u32)frame[4] << 8 | (u32)frame[5] << 16 | (u32)frame[6] << 24);
+		if (!param_write(&param_tbl[id], v))
+			status = CONSOLE_BIN_ERR_RANGE;
+	}
+	else if (cmd != CONSOLE_BIN_GET) {
+		status = CONSOLE_BIN_ERR_CMD;
+	}
+
+	if (cmd != CONSOLE_BIN_STREAM && id < num_params)
+		v = param_read(&param_tbl[id]);
+
+	u8 reply[9] = { CONSOLE_BIN_SYNC, cmd | CONSOLE_BIN_REPLY, id, status,
+					(u8)v, (u8)(v >> 8), (u8)(v >> 16), (u8)(v >> 24), 0 };
+	for (u8 i = 1; i < 8; i++)
+		reply[8] ^= reply[i];
+
+	for (u8 i = 0; i < sizeof(reply); i++)
+		console_putc(reply[i]);
+}
+
+
+/**
+ * Feeds one received byte to the parser
+ *
+ */
+static void parse_byte(u8 c)
+{
+	if (parse_state == PARSE_BINARY) {
+		frame[frame_len++] = c;
+		frame_us = timebase_now_us();
+		if (frame_len == CONSOLE_BIN_FRAME_LEN) {
+			exec_frame();
+			parse_state = PARSE_TEXT;
+		}
+		return;
+	}
+
+	// a sync byte at the start of a line switches to a binary frame
+	if (c == CONSOLE_BIN_SYNC && line_len == 0) {
+		frame[0] = c;
+		frame_len = 1;
+		frame_us = timebase_now_us();
+		parse_state = PARSE_BINARY;
+		return;
+	}
+
+	if (c == '\r' || c == '\n') {
+		if (line_overflow)
+			console_puts("ERR\r\n");
+		else if (line_len > 0) {
+			line[line_len] = '\0';
+			exec_line();
+		}
+		line_len = 0;
+		line_overflow = false;
+		return;
+	}
+
+	if (line_len < CONSOLE_LINE_LEN - 1)
+		line[line_len++] = (char)c;
+	else
+		line_overflow = true;
+}
+
+
+/**
+ * Sets up the console
+ *
+ * @param   uart_inst   initialized UART Lite instance
+ * @param   params      parameter table; the binary protocol id is the index
+ * @param   nparams     number of parameters
+ * @param   cmds        application command table
+ * @param   ncmds       number of commands
+ *
+ */
+void console_init(XUartLite *uart_inst, const console_param_t *params, u8 nparams,
+				  const console_cmd_t *cmds, u8 ncmds)
+{
+	uart_p = uart_inst;
+	param_tbl = params;
+	num_params = nparams;
+	cmd_tbl = cmds;
+	num_cmds = ncmds;
+
+	parse_state = PARSE_TEXT;
+	line_len = 0;
+	line_overflow = false;
+	frame_len = 0;
+	tx_head = 0;
+	tx_tail = 0;
+}
+
+
+/**
+ * Installs the handler for CONSOLE_BIN_STREAM frames and "pt" lines
+ *
+ * @param   fn  handler, NULL to reject them
+ *
+ */
+void console_set_stream(console_stream_fn fn)
+{
+	stream_fn = fn;
+}
+
+
+/**
+ * Console task: sends queued output and parses whatever is waiting in the
+ * receive FIFO
+ *
+ * @note    Never waits for input or for the transmitter. At most
+ *          CONSOLE_MAX_BYTES bytes are handled and one FIFO of output is sent
+ *          per call, which at 115200 baud keeps up with a 1 ms period
+ *
+ *          A binary frame is dropped when the FIFO is found empty more than
+ *          CONSOLE_FRAME_GAP_US after its last byte. Nothing arrived in that
+ *          time, so the line really was quiet, and the next byte starts over
+ *          looking for a sync byte instead of completing a stale frame
+ *
+ */
+void console_task(void)
+{
+	u8 buf[CONSOLE_MAX_BYTES];
+	unsigned int n;
+
+	if (uart_p == NULL)
+		return;
+
+	console_tx_drain();
+
+	n = XUartLite_Recv(uart_p, buf, CONSOLE_MAX_BYTES);
+
+	if (n == 0 && parse_state == PARSE_BINARY &&
+		timebase_now_us() - frame_us > CONSOLE_FRAME_GAP_US) {
+		parse_state = PARSE_TEXT;
+		frame_len = 0;
+	}
+
+	for (unsigned int i = 0; i < n; i++)
+		parse_byte(buf[i]);
+}
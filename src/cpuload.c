@@ -0,0 +1,129 @@
+/****************************************************************************************
+*   @file cpuload.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note CPU load measurement. See cpuload.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "cpuload.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "xil_printf.h"
+
+/***************************** Global variables ****************************/
+static u32 window_start = 0;				// timer ticks at the start of the window
+static u32 window_ticks = 0;				// length of the last closed window
+static u32 last_busy[SCHED_MAX_TASKS];		// busy_ticks of each task at the window start
+static u16 task_load[SCHED_MAX_TASKS];
+static u16 total_load = 0;
+static u16 peak_load = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Starts the first window
+ *
+ * @note    Call after sched_init()
+ *
+ */
+void load_init(void)
+{
+	for (u8 i = 0; i < SCHED_MAX_TASKS; i++) {
+		const sched_stats_t *st = sched_get_stats(i);
+		last_busy[i] = st ? st->busy_ticks : 0;
+		task_load[i] = 0;
+	}
+
+	window_start = timebase_now_ticks();
+	window_ticks = 0;
+	total_load = 0;
+	peak_load = 0;
+}
+
+
+/**
+ * Closes the window and computes the loads
+ *
+ * @note    Run from the scheduler at the window period. Only this task divides
+ *
+ */
+void load_task(void)
+{
+	u32 now = timebase_now_ticks();
+	u32 window = now - window_start;
+	u32 busy = 0;
+	u32 per_mille;
+
+	// ticks per 0.1 %
+	per_mille = window / 1000;
+	if (per_mille == 0)
+		return;
+
+	for (u8 i = 0; i < sched_num_tasks(); i++) {
+		u32 b = sched_get_stats(i)->busy_ticks;
+		u32 d = b - last_busy[i];
+
+		// statistics were cleared during the window
+		if (d > window)
+			d = b;
+
+		last_busy[i] = b;
+		task_load[i] = (d < window) ? d / per_mille : 1000;
+		busy += d;
+	}
+
+	window_start = now;
+	window_ticks = window;
+	total_load = (busy < window) ? busy / per_mille : 1000;
+	if (total_load > peak_load)
+		peak_load = total_load;
+}
+
+
+/**
+ * Returns the load of the last window, 0.1 %
+ *
+ */
+u16 load_total(void)
+{
+	return total_load;
+}
+
+
+/**
+ * Returns the highest window load since boot, 0.1 %
+ *
+ */
+u16 load_peak(void)
+{
+	return peak_load;
+}
+
+
+/**
+ * Returns the load of one task in the last window, 0.1 %
+ *
+ */
+u16 load_of_task(u8 id)
+{
+	return (id < sched_num_tasks()) ? task_load[id] : 0;
+}
+
+
+/**
+ * Prints the loads of the last window over the UART
+ *
+ * @note    LOAD,<window us>,<total>,<peak> then LOAD,<task>,<load> per task,
+ *          loads in 0.1 %
+ *
+ */
+void load_report(void)
+{
+	xil_printf("LOAD,%u,%u,%u\r\n", window_ticks / timebase_ticks_per_us(), total_load, peak_load);
+
+	for (u8 i = 0; i < sched_num_tasks(); i++)
+		xil_printf("LOAD,%s,%u\r\n", sched_get_task(i)->name, task_load[i]);
+}
@@ -0,0 +1,215 @@
+/****************************************************************************************
+*   @file diag.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Peripheral self-tests and AXI latency. See diag.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "diag.h"
+#include "timebase.h"
+#include "supervisor.h"
+#include "scale.h"
+#include "system.h"
+#include "PmodENC544.h"
+#include "nexys4io.h"
+#include "xuartlite_l.h"
+#include "xtmrctr_l.h"
+#include "xwdttb_l.h"
+#include "xil_io.h"
+#include "xil_printf.h"
+
+/************************** Constant Definitions ***************************/
+static const diag_periph_t periphs[] = {
+	//  name		base								self-test					read register							write register
+	{ "pmodhb3",	XPAR_PMODHB3_IP_0_S00_AXI_BASEADDR,	PMODHB3_IP_Reg_SelfTest,	PMODHB3_IP_S00_AXI_SLV_REG0_OFFSET,		PMODHB3_IP_S00_AXI_SLV_REG1_OFFSET },
+	{ "pmodenc",	XPAR_PMODENC544_0_S00_AXI_BASEADDR,	PMODENC544_Reg_SelfTest,	PMODENC544_ROTARY_COUNT_REG_OFFSET,		PMODENC544_SPARE_REG_OFFSET },
+	{ "nexys4io",	N4IO_BASEADDR,						NEXYS4IO_Reg_SelfTest,		NEXYS4IO_BTNSW_IN_OFFSET,				NEXYS4IO_LEDS_DATA_OFFSET },
+	{ "uartlite",	XPAR_UARTLITE_1_BASEADDR,			NULL,						XUL_STATUS_REG_OFFSET,					DIAG_NO_WRITE },
+	{ "timer",		XPAR_TMRCTR_0_BASEADDR,				NULL,						XTC_TCR_OFFSET,							DIAG_NO_WRITE },
+	{ "wdt",		XPAR_AXI_TIMEBASE_WDT_0_BASEADDR,	NULL,						XWT_TWCSR0_OFFSET,						DIAG_NO_WRITE },
+};
+
+#define DIAG_NUM_PERIPHS	(sizeof(periphs) / sizeof(periphs[0]))
+
+static const diag_calc_t calcs[] = {
+	{ "scale",		scale_selftest_start,	scale_selftest_step },
+};
+
+#define DIAG_NUM_CALCS		(sizeof(calcs) / sizeof(calcs[0]))
+
+/***************************** Global variables ****************************/
+static bool running = false;
+static u8 next_periph = 0;
+static u8 failures = 0;
+static bool calc_started = false;	// the current software self-test has been started
+static u32 calc_us = 0;				// time spent in its slices so far
+static u32 timer_cost = 0;			// ticks for two back-to-back timer reads
+
+/************************** Function Definitions ***************************/
+/**
+ * Measures the cost of reading the timer around an empty access
+ *
+ */
+static u32 diag_timer_cost(void)
+{
+	u32 best = 0xFFFFFFFF;
+
+	for (u8 i = 0; i < DIAG_SAMPLES; i++) {
+		u32 t0 = timebase_now_ticks();
+		u32 t1 = timebase_now_ticks();
+		if (t1 - t0 < best)
+			best = t1 - t0;
+	}
+
+	return best;
+}
+
+
+/**
+ * Times DIAG_SAMPLES reads, or read-back writes, of one register
+ *
+ */
+static void diag_time(u32 addr, bool write, diag_latency_t *lat)
+{
+	u32 sum = 0;
+
+	lat->min = 0xFFFFFFFF;
+	lat->max = 0;
+
+	for (u8 i = 0; i < DIAG_SAMPLES; i++) {
+		u32 v = Xil_In32(addr);
+		u32 t0 = timebase_now_ticks();
+		if (write)
+			Xil_Out32(addr, v);
+		else
+			v = Xil_In32(addr);
+		u32 t1 = timebase_now_ticks();
+
+		u32 d = t1 - t0;
+		d = (d > timer_cost) ? d - timer_cost : 0;
+
+		sum += d;
+		if (d < lat->min)
+			lat->min = d;
+		if (d > lat->max)
+			lat->max = d;
+	}
+
+	lat->avg = sum / DIAG_SAMPLES;
+}
+
+
+/**
+ * Starts a diagnostic run. The H-bridge is disabled for the whole run
+ *
+ */
+void diag_start(void)
+{
+	sup_safe_state();
+
+	running = true;
+	next_periph = 0;
+	failures = 0;
+	calc_started = false;
+	timer_cost = diag_timer_cost();
+
+	xil_printf("DIAG,begin,%u\r\n", timebase_ticks_per_us());
+}
+
+
+/**
+ * Tests the next peripheral, then the next software self-test
+ *
+ * @return  true once every peripheral has been tested
+ *
+ */
+bool diag_step(void)
+{
+	if (!running)
+		return true;
+
+	if (next_periph >= DIAG_NUM_PERIPHS + DIAG_NUM_CALCS) {
+		xil_printf("DIAG,end,%d\r\n", failures);
+		running = false;
+		return true;
+	}
+
+	if (next_periph >= DIAG_NUM_PERIPHS) {
+		const diag_calc_t *c = &calcs[next_periph - DIAG_NUM_PERIPHS];
+		XStatus sts = XST_FAILURE;
+
+		if (!calc_started) {
+			c->start();
+			calc_started = true;
+			calc_us = 0;
+		}
+
+		u32 t0 = timebase_now_us();
+		bool done = c->step(&sts);
+		calc_us += timebase_now_us() - t0;
+
+		if (!done)
+			return false;
+
+		if (sts != XST_SUCCESS)
+			failures++;
+		xil_printf("DIAG,%s,selftest,%s,%u\r\n", c->name, (sts == XST_SUCCESS) ? "PASS" : "FAIL", calc_us);
+
+		next_periph++;
+		calc_started = false;
+		return false;
+	}
+
+	const diag_periph_t *p = &periphs[next_periph++];
+	diag_latency_t lat;
+
+	if (p->selftest != NULL) {
+		u32 t0 = timebase_now_us();
+		XStatus sts = p->selftest(p->base);
+		u32 t1 = timebase_now_us();
+
+		if (sts != XST_SUCCESS)
+			failures++;
+		xil_printf("DIAG,%s,selftest,%s,%u\r\n", p->name, (sts == XST_SUCCESS) ? "PASS" : "FAIL", t1 - t0);
+
+		// the self-test leaves its pattern in the registers
+		sup_safe_state();
+	}
+	else {
+		xil_printf("DIAG,%s,selftest,NONE,0\r\n", p->name);
+	}
+
+	diag_time(p->base + p->rd_offset, false, &lat);
+	xil_printf("DIAG,%s,rd,%u,%u,%u\r\n", p->name, lat.min, lat.avg, lat.max);
+
+	if (p->wr_offset != DIAG_NO_WRITE) {
+		diag_time(p->base + p->wr_offset, true, &lat);
+		xil_printf("DIAG,%s,wr,%u,%u,%u\r\n", p->name, lat.min, lat.avg, lat.max);
+	}
+
+	return false;
+}
+
+
+/**
+ * Returns true while a diagnostic run is in progress
+ *
+ */
+bool diag_running(void)
+{
+	return running;
+}
+
+
+/**
+ * Returns the number of failed self-tests in the last run
+ *
+ */
+u8 diag_failures(void)
+{
+	return failures;
+}
@@ -0,0 +1,233 @@
+/****************************************************************************************
+*   @file display.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Seven-segment display pages. See display.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "display.h"
+#include "nexys4io.h"
+
+/************************** Constant Definitions ***************************/
+#define DISP_VALUE_MAX		999999
+#define DISP_VALUE_MIN		-99999
+#define DISP_PAIR_MAX		9999
+
+/***************************** Global variables ****************************/
+static const disp_page_t *page_tbl = NULL;
+static u8 num_pages = 0;
+static u8 cur_page = 0;
+static u8 refresh_page = 0;			// round-robin refresh of the pages not shown
+
+static u32 cache_hi[DISP_MAX_PAGES];
+static u32 cache_lo[DISP_MAX_PAGES];
+
+static u32 shown_hi, shown_lo;		// what the SSEG_DATA registers hold
+static bool shown_valid = false;	// false while another mode owns the display
+
+static u16 cycle_ticks = 0;			// 0: no automatic page cycling
+static u16 cycle_count = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Packs four character codes into an SSEG_DATA word, d[3] leftmost
+ *
+ */
+static u32 pack(const u8 *d, u8 dp)
+{
+	return (u32)dp << 24 | (u32)d[3] << 18 | (u32)d[2] << 12 | (u32)d[1] << 6 | d[0];
+}
+
+
+/**
+ * Writes v in decimal into n digits, d[0] rightmost
+ *
+ * @param   zeros   true to pad with leading zeros, false to blank them
+ *
+ */
+static void put_dec(u8 *d, u8 n, u32 v, bool zeros)
+{
+	for (u8 i = 0; i < n; i++) {
+		d[i] = (v || i == 0 || zeros) ? v % 10 : CC_BLANK;
+		v /= 10;
+	}
+}
+
+
+/**
+ * Converts the current values of a page into its cached words
+ *
+ */
+static void render(u8 p)
+{
+	const disp_page_t *pg = &page_tbl[p];
+	u8 d[8];		// d[7] leftmost
+	u8 dp = 0;
+
+	if (pg->fmt == DISP_FMT_PAIR) {
+		int32_t hi = pg->get();
+		int32_t lo = pg->get_lo ? pg->get_lo() : 0;
+
+		hi = (hi < 0) ? 0 : (hi > DISP_PAIR_MAX) ? DISP_PAIR_MAX : hi;
+		lo = (lo < 0) ? 0 : (lo > DISP_PAIR_MAX) ? DISP_PAIR_MAX : lo;
+		put_dec(&d[4], 4, hi, true);
+		put_dec(&d[0], 4, lo, true);
+	}
+	else {
+		int32_t v = pg->get();
+		u32 mag;
+
+		v = (v < DISP_VALUE_MIN) ? DISP_VALUE_MIN : (v > DISP_VALUE_MAX) ? DISP_VALUE_MAX : v;
+		mag = (v < 0) ? -v : v;
+		put_dec(&d[0], 6, mag, false);
+
+		// minus sign just left of the most significant digit
+		if (v < 0) {
+			u8 i = 0;
+			while (i < 5 && d[i + 1] != CC_BLANK)
+				i++;
+			d[i + 1] = CC_SEGg;
+		}
+
+		d[7] = (p + 1) % 10;
+		d[6] = CC_BLANK;
+		dp = DP_3;
+	}
+
+	cache_hi[p] = pack(&d[4], dp);
+	cache_lo[p] = pack(&d[0], 0);
+}
+
+
+/**
+ * Writes the cached words of the selected page that differ from the display
+ *
+ */
+static void show(void)
+{
+	if (!shown_valid || cache_hi[cur_page] != shown_hi)
+		NX4IO_SSEG_setSSEG_DATA(SSEGHI, cache_hi[cur_page]);
+	if (!shown_valid || cache_lo[cur_page] != shown_lo)
+		NX4IO_SSEG_setSSEG_DATA(SSEGLO, cache_lo[cur_page]);
+
+	shown_hi = cache_hi[cur_page];
+	shown_lo = cache_lo[cur_page];
+	shown_valid = true;
+}
+
+
+/**
+ * Registers the page table and fills the cache
+ *
+ * @param   pages   application page table
+ * @param   npages  number of pages (at most DISP_MAX_PAGES)
+ *
+ */
+void disp_init(const disp_page_t *pages, u8 npages)
+{
+	page_tbl = pages;
+	num_pages = (npages > DISP_MAX_PAGES) ? DISP_MAX_PAGES : npages;
+	cur_page = 0;
+	refresh_page = 0;
+	cycle_count = 0;
+	shown_valid = false;
+
+	for (u8 i = 0; i < num_pages; i++)
+		render(i);
+}
+
+
+/**
+ * Selects a page. While the display is active its cached words are shown at once
+ *
+ */
+void disp_select(u8 page)
+{
+	if (page >= num_pages)
+		return;
+
+	cur_page = page;
+	cycle_count = 0;
+
+	if (shown_valid)
+		show();
+}
+
+
+/**
+ * Selects the next page, wrapping around
+ *
+ */
+void disp_next(void)
+{
+	if (num_pages)
+		disp_select((cur_page + 1) % num_pages);
+}
+
+
+/**
+ * Selects the previous page, wrapping around
+ *
+ */
+void disp_prev(void)
+{
+	if (num_pages)
+		disp_select(cur_page ? cur_page - 1 : num_pages - 1);
+}
+
+
+/**
+ * Returns the selected page
+ *
+ */
+u8 disp_page(void)
+{
+	return cur_page;
+}
+
+
+/**
+ * Sets the automatic page cycling interval
+ *
+ * @param   ticks   disp_task() calls per page, 0 to stay on the selected page
+ *
+ */
+void disp_set_cycle(u16 ticks)
+{
+	cycle_ticks = ticks;
+	cycle_count = 0;
+}
+
+
+/**
+ * Display task: refreshes the cache and updates the display
+ *
+ * @param   active  false while another mode owns the display. The registers
+ *                  are rewritten in full once it becomes active again
+ *
+ */
+void disp_task(bool active)
+{
+	if (!active || num_pages == 0) {
+		shown_valid = false;
+		return;
+	}
+
+	if (cycle_ticks && ++cycle_count >= cycle_ticks) {
+		cur_page = (cur_page + 1) % num_pages;
+		cycle_count = 0;
+	}
+
+	render(cur_page);
+
+	// keep the other pages fresh so selecting one shows current values
+	refresh_page = (refresh_page + 1) % num_pages;
+	if (refresh_page != cur_page)
+		render(refresh_page);
+
+	show();
+}
@@ -0,0 +1,272 @@
+/****************************************************************************************
+*   @file fault.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Fault manager state machine. See fault.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "fault.h"
+#include "sections.h"
+
+/************************** Constant Definitions ***************************/
+#define FAULT_HEALTHY_US		10000000	// clean time in RUNNING before the trip count is forgotten
+#define FAULT_MAX_DT_US			1000000		// longest period taken from one tick
+#define FAULT_RAMP_Q8_PER_MS	(FAULT_RAMP_PWM_PER_S * 256 / 1000)
+
+/***************************** Global variables ****************************/
+static u8 state = FAULT_ST_RUNNING;
+static u8 code = FAULT_NONE;
+static u16 applied_q8 = 0;		// PWM allowed on the previous tick, Q8 so the ramp moves at fast rates
+static u8 window_pwm = 0;		// lowest PWM allowed since the last tach reading
+static u8 confirm_cnt = 0;		// consecutive tach readings the current condition has been seen in
+static u8 trips = 0;			// confirmed faults since the last clean run
+static u32 state_us = 0;		// time spent in the current state
+
+/************************** Function Definitions ***************************/
+/**
+ * Checks a new tach reading and the PWM applied during its window for a
+ * fault condition
+ *
+ * @return  the fault code of the condition seen, FAULT_NONE if healthy
+ *
+ */
+static u8 fault_detect(u32 rpm_raw)
+{
+	if (rpm_raw > FAULT_SENSOR_MAX_RPM)
+		return FAULT_SENSOR;
+
+	if (rpm_raw >= FAULT_OVERSPEED_RPM)
+		return FAULT_OVERSPEED;
+
+	if (window_pwm >= FAULT_STALL_PWM && rpm_raw == 0)
+		return FAULT_STALL;
+
+	return FAULT_NONE;
+}
+
+
+/**
+ * Moves to a new state and restarts the state timer
+ *
+ */
+static void fault_enter(u8 new_state)
+{
+	state = new_state;
+	state_us = 0;
+}
+
+
+/**
+ * Confirms a fault and starts ramping the motor down
+ *
+ */
+static void fault_trip(u8 fault)
+{
+	code = fault;
+	confirm_cnt = 0;
+	trips++;
+	fault_enter(FAULT_ST_RAMP_DOWN);
+}
+
+
+/**
+ * Resets the fault manager to RUNNING
+ *
+ */
+void fault_init(void)
+{
+	code = FAULT_NONE;
+	applied_q8 = 0;
+	window_pwm = 0;
+	confirm_cnt = 0;
+	trips = 0;
+	fault_enter(FAULT_ST_RUNNING);
+}
+
+
+/**
+ * Runs the fault state machine for one control tick
+ *
+ * @param   rpm_raw     tach reading for this tick, as returned by the driver
+ * @param   fresh       true if the reading is new since the previous tick
+ * @param   dt_us       measured period of this tick
+ * @param   pwm_cmd     PWM requested by the controller
+ *
+ * @return  the PWM that may be applied to the H-bridge this tick
+ *
+ */
+HOT_CODE u8 fault_step(u32 rpm_raw, bool fresh, u32 dt_us, u8 pwm_cmd)
+{
+	u8 cond;
+	u8 pwm;
+	u32 step_q8;
+
+	if (dt_us > FAULT_MAX_DT_US)
+		dt_us = FAULT_MAX_DT_US;
+	state_us = (state_us > 0xFFFFFFFF - dt_us) ? 0xFFFFFFFF : state_us + dt_us;
+
+	// a reading that is not new carries no new evidence
+	cond = fresh ? fault_detect(rpm_raw) : FAULT_NONE;
+	if (fresh)
+		window_pwm = 0xFF;
+
+	switch (state) {
+		case FAULT_ST_RUNNING:
+			if (cond != FAULT_NONE) {
+				// overspeed is debounced too: one overshoot sample is not a fault
+				code = cond;
+				confirm_cnt = 1;
+				fault_enter(FAULT_ST_DEGRADED);
+			}
+			else if (state_us >= FAULT_HEALTHY_US) {
+				trips = 0;
+			}
+			break;
+
+		case FAULT_ST_DEGRADED:
+			if (!fresh)
+				break;
+			if (cond != FAULT_NONE) {
+				if (++confirm_cnt >= FAULT_CONFIRM_SAMPLES)
+					fault_trip(cond);
+			}
+			else {
+				// condition went away before it was confirmed
+				code = FAULT_NONE;
+				confirm_cnt = 0;
+				fault_enter(FAULT_ST_RUNNING);
+			}
+			break;
+
+		case FAULT_ST_STOPPED:
+			if (state_us >= FAULT_RETRY_US) {
+				code = FAULT_NONE;
+				fault_enter(FAULT_ST_RUNNING);
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	switch (state) {
+		case FAULT_ST_RUNNING:
+			applied_q8 = (u16)pwm_cmd << 8;
+			break;
+
+		case FAULT_ST_DEGRADED:
+			pwm = (pwm_cmd > FAULT_DEGRADED_PWM_MAX) ? FAULT_DEGRADED_PWM_MAX : pwm_cmd;
+			applied_q8 = (u16)pwm << 8;
+			break;
+
+		case FAULT_ST_RAMP_DOWN:
+			step_q8 = dt_us * FAULT_RAMP_Q8_PER_MS / 1000;
+			applied_q8 = (applied_q8 > step_q8) ? applied_q8 - step_q8 : 0;
+			if (applied_q8 < 0x100) {
+				applied_q8 = 0;
+				if (code == FAULT_USER || trips >= FAULT_MAX_RETRIES)
+					fault_enter(FAULT_ST_LATCHED);
+				else
+					fault_enter(FAULT_ST_STOPPED);
+			}
+			break;
+
+		default:
+			applied_q8 = 0;
+			break;
+	}
+
+	pwm = applied_q8 >> 8;
+	if (pwm < window_pwm)
+		window_pwm = pwm;
+
+	return pwm;
+}
+
+
+/**
+ * Forces a fault from outside the state machine. The motor is ramped down
+ * and, for FAULT_USER, the fault is latched
+ *
+ */
+void fault_raise(u8 fault)
+{
+	// already stopping: just take over the fault code so FAULT_USER still latches
+	if (state == FAULT_ST_RAMP_DOWN || state == FAULT_ST_LATCHED) {
+		code = fault;
+		return;
+	}
+
+	fault_trip(fault);
+}
+
+
+/**
+ * Operator acknowledge. Clears a stopped or latched fault
+ *
+ * @return  true if the drive is back to RUNNING, false if it is still ramping down
+ *
+ */
+bool fault_clear(void)
+{
+	if (state == FAULT_ST_RAMP_DOWN)
+		return false;
+
+	code = FAULT_NONE;
+	confirm_cnt = 0;
+	trips = 0;
+	fault_enter(FAULT_ST_RUNNING);
+
+	return true;
+}
+
+
+/**
+ * Returns the current state (FAULT_ST_*)
+ *
+ */
+u8 fault_state(void)
+{
+	return state;
+}
+
+
+/**
+ * Returns the active fault code (FAULT_*), FAULT_NONE when running
+ *
+ */
+u8 fault_code(void)
+{
+	return code;
+}
+
+
+/**
+ * Returns true if the H-bridge enable may be asserted
+ *
+ */
+bool fault_bridge_enabled(void)
+{
+	return state < FAULT_ST_STOPPED;
+}
+
+
+/**
+ * Returns a printable name for a state
+ *
+ */
+const char *fault_state_str(u8 st)
+{
+	switch (st) {
+		case FAULT_ST_RUNNING:		return "running";
+		case FAULT_ST_DEGRADED:		return "degraded";
+		case FAULT_ST_RAMP_DOWN:	return "ramp-down";
+		case FAULT_ST_STOPPED:		return "stopped";
+		case FAULT_ST_LATCHED:		return "latched";
+		default:					return "?";
+	}
+}
@@ -0,0 +1,234 @@
+/****************************************************************************************
+*   @file flightrec.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Control loop flight recorder. See flightrec.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "flightrec.h"
+#include "xil_printf.h"
+#include "sections.h"
+
+/************************** Constant Definitions ***************************/
+#define FR_MAGIC		0x46524543		// "FREC"
+#define FR_MASK			(FR_DEPTH - 1)
+
+_Static_assert(sizeof(fr_sample_t) == 20, "fr_sample_t has padding");
+_Static_assert((FR_DEPTH & FR_MASK) == 0, "FR_DEPTH must be a power of 2");
+
+/**************************** Type Definitions *****************************/
+// Kept in .noinit so a recording survives a watchdog reset
+typedef struct {
+	u32 magic;
+	u16 head;				// next slot written
+	u16 count;				// valid samples, up to FR_DEPTH
+	u16 post_left;			// samples still to record after the trigger
+	u8 cause;				// FR_CAUSE_*, NONE while recording
+	bool triggered;
+	fr_sample_t samples[FR_DEPTH];
+} fr_record_t;
+
+/***************************** Global variables ****************************/
+static fr_record_t rec NOINIT_DATA;
+
+static fr_sample_t scratch;		// written instead of the ring while frozen
+static u8 pending_cause = FR_CAUSE_NONE;	// applied once the post-trigger samples are in
+static u8 trig_type = FR_TRIG_NONE;
+static u16 trig_level = 0;
+
+static bool dumping = false;
+static u16 dump_idx = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Initializes the recorder
+ *
+ * @param   preserve    true to keep a recording made before a reset. A
+ *                      recording still running at the reset is frozen with
+ *                      FR_CAUSE_RESET
+ *
+ */
+void fr_init(bool preserve)
+{
+	dumping = false;
+
+	if (preserve && rec.magic == FR_MAGIC && rec.count <= FR_DEPTH && rec.head < FR_DEPTH) {
+		if (rec.cause == FR_CAUSE_NONE)
+			rec.cause = FR_CAUSE_RESET;
+		return;
+	}
+
+	fr_arm();
+}
+
+
+/**
+ * Discards the recording and starts recording again
+ *
+ */
+void fr_arm(void)
+{
+	rec.magic = FR_MAGIC;
+	rec.head = 0;
+	rec.count = 0;
+	rec.post_left = 0;
+	rec.triggered = false;
+	rec.cause = FR_CAUSE_NONE;
+	dumping = false;
+}
+
+
+/**
+ * Returns the slot for this control tick. The caller fills every field and then
+ * calls fr_commit()
+ *
+ */
+HOT_CODE fr_sample_t *fr_next(void)
+{
+	return (rec.cause == FR_CAUSE_NONE) ? &rec.samples[rec.head] : &scratch;
+}
+
+
+/**
+ * Completes the sample returned by fr_next() and checks the trigger
+ *
+ * @param   fault   true while the fault manager reports a fault
+ *
+ */
+HOT_CODE void fr_commit(bool fault)
+{
+	if (rec.cause != FR_CAUSE_NONE)
+		return;
+
+	const fr_sample_t *s = &rec.samples[rec.head];
+	rec.head = (rec.head + 1) & FR_MASK;
+	if (rec.count < FR_DEPTH)
+		rec.count++;
+
+	if (!rec.triggered) {
+		u8 cause = FR_CAUSE_NONE;
+
+		if (fault)
+			cause = FR_CAUSE_FAULT;
+		else if (trig_type == FR_TRIG_ERROR && (s->error > trig_level || -s->error > trig_level))
+			cause = FR_CAUSE_TRIGGER;
+		else if (trig_type == FR_TRIG_RPM && (s->rpm > trig_level || -s->rpm > trig_level))
+			cause = FR_CAUSE_TRIGGER;
+
+		if (cause == FR_CAUSE_NONE)
+			return;
+
+		rec.triggered = true;
+		rec.post_left = FR_POST_TRIGGER;
+		pending_cause = cause;
+	}
+	else {
+		rec.post_left--;
+	}
+
+	if (rec.post_left == 0)
+		rec.cause = pending_cause;
+}
+
+
+/**
+ * Triggers the recorder from software
+ *
+ */
+void fr_trigger(void)
+{
+	if (rec.cause == FR_CAUSE_NONE && !rec.triggered) {
+		rec.triggered = true;
+		rec.post_left = FR_POST_TRIGGER;
+		pending_cause = FR_CAUSE_MANUAL;
+	}
+}
+
+
+/**
+ * Sets the trigger condition
+ *
+ * @param   type    FR_TRIG_* condition
+ * @param   level   threshold in PWM counts (FR_TRIG_ERROR) or RPM (FR_TRIG_RPM)
+ *
+ */
+void fr_set_trigger(u8 type, u16 level)
+{
+	trig_type = type;
+	trig_level = (level > INT16_MAX) ? INT16_MAX : level;
+}
+
+
+/**
+ * Returns true once the recording is frozen
+ *
+ */
+bool fr_frozen(void)
+{
+	return rec.cause != FR_CAUSE_NONE;
+}
+
+
+/**
+ * Returns the FR_CAUSE_* the recording was frozen for
+ *
+ */
+u8 fr_cause(void)
+{
+	return rec.cause;
+}
+
+
+/**
+ * Returns the number of samples recorded
+ *
+ */
+u16 fr_count(void)
+{
+	return rec.count;
+}
+
+
+/**
+ * Starts printing the recording from fr_task(). A live recording is frozen first
+ *
+ */
+void fr_dump_start(void)
+{
+	if (rec.cause == FR_CAUSE_NONE)
+		rec.cause = FR_CAUSE_MANUAL;
+
+	xil_printf("FR,%d,%d\r\n", rec.cause, rec.count);
+	dump_idx = 0;
+	dumping = true;
+}
+
+
+/**
+ * Recorder task: prints up to FR_DUMP_LINES samples of a dump in progress
+ *
+ */
+void fr_task(void)
+{
+	if (!dumping)
+		return;
+
+	for (u8 n = 0; n < FR_DUMP_LINES; n++) {
+		if (dump_idx >= rec.count) {
+			xil_printf("FR,end\r\n");
+			dumping = false;
+			return;
+		}
+
+		// oldest sample first
+		const fr_sample_t *s = &rec.samples[(rec.head - rec.count + dump_idx) & FR_MASK];
+		xil_printf("FR,%d,%u,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\r\n", dump_idx, s->t_us,
+				   s->stpt, s->rpm, s->error, s->integ, s->pwm, s->sw, s->btn,
+				   s->status, s->fault, s->dt_us);
+		dump_idx++;
+	}
+}
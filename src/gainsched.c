@@ -0,0 +1,194 @@
+/****************************************************************************************
+*   @file gainsched.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Gain scheduling across the RPM range. See gainsched.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "gainsched.h"
+#include "xil_printf.h"
+#include "sections.h"
+
+/************************** Constant Definitions ***************************/
+// Default breakpoints, evenly spread over the setpoint range
+static const u16 default_rpm[GS_NUM_POINTS] = { 0, 700, 1400, 2100, 2800, 3500, 4200, 5000 };
+
+/***************************** Global variables ****************************/
+static u16 bp_rpm[GS_NUM_POINTS];
+static u16 bp_gain[GS_NUM_POINTS][GS_NUM_GAINS];
+static int32_t slope_q16[GS_NUM_POINTS - 1][GS_NUM_GAINS];	// gain change per RPM, Q16
+static bool enabled = false;
+static bool seeded = false;		// table holds real gains, set on first enable
+
+/************************** Function Definitions ***************************/
+/**
+ * Loads the default breakpoints with all gains zero, scheduling off
+ *
+ */
+void gs_init(void)
+{
+	for (u8 i = 0; i < GS_NUM_POINTS; i++) {
+		bp_rpm[i] = default_rpm[i];
+		for (u8 j = 0; j < GS_NUM_GAINS; j++)
+			bp_gain[i][j] = 0;
+	}
+
+	enabled = false;
+	seeded = false;
+	gs_update();
+}
+
+
+/**
+ * Turns scheduling on or off
+ *
+ * @param   en      true to take the gains from the table
+ * @param   seed    gain set copied to every breakpoint the first time scheduling is
+ *                  turned on, so that it starts out behaving like the fixed gains
+ *
+ */
+void gs_set_enabled(bool en, const u16 *seed)
+{
+	if (en && !seeded) {
+		for (u8 i = 0; i < GS_NUM_POINTS; i++) {
+			for (u8 j = 0; j < GS_NUM_GAINS; j++)
+				bp_gain[i][j] = seed[j];
+		}
+		seeded = true;
+		gs_update();
+	}
+
+	enabled = en;
+}
+
+
+/**
+ * Returns true if the gains come from the table
+ *
+ */
+bool gs_enabled(void)
+{
+	return enabled;
+}
+
+
+/**
+ * Returns the gain set of a breakpoint for editing. Call gs_update() after changing it
+ *
+ */
+u16 *gs_point_gains(u8 idx)
+{
+	return bp_gain[(idx < GS_NUM_POINTS) ? idx : GS_NUM_POINTS - 1];
+}
+
+
+/**
+ * Recomputes the interpolation slopes after the table was edited
+ *
+ */
+void gs_update(void)
+{
+	for (u8 i = 0; i < GS_NUM_POINTS - 1; i++) {
+		int32_t span = bp_rpm[i + 1] - bp_rpm[i];
+
+		for (u8 j = 0; j < GS_NUM_GAINS; j++) {
+			if (bp_gain[i][j] > GS_GAIN_MAX)
+				bp_gain[i][j] = GS_GAIN_MAX;
+			slope_q16[i][j] = (((int32_t)bp_gain[i + 1][j] - bp_gain[i][j]) << 16) / span;
+		}
+	}
+}
+
+
+/**
+ * Moves a breakpoint
+ *
+ * @param   idx     breakpoint index
+ * @param   rpm     new speed, must lie strictly between its neighbours
+ *
+ * @return  true if the breakpoint was moved
+ *
+ */
+bool gs_set_rpm(u8 idx, u16 rpm)
+{
+	if (idx >= GS_NUM_POINTS)
+		return false;
+	if (idx > 0 && rpm <= bp_rpm[idx - 1])
+		return false;
+	if (idx < GS_NUM_POINTS - 1 && rpm >= bp_rpm[idx + 1])
+		return false;
+
+	bp_rpm[idx] = rpm;
+	gs_update();
+
+	return true;
+}
+
+
+/**
+ * Returns the speed of a breakpoint
+ *
+ */
+u16 gs_point_rpm(u8 idx)
+{
+	return (idx < GS_NUM_POINTS) ? bp_rpm[idx] : 0;
+}
+
+
+/**
+ * Interpolates the gains for a speed
+ *
+ * @param   rpm     scheduling speed
+ * @param   k       gain set out, indexed like kpid
+ *
+ */
+HOT_CODE void gs_gains(u16 rpm, u16 *k)
+{
+	u8 lo = 0, hi = GS_NUM_POINTS - 1;
+
+	if (rpm <= bp_rpm[0]) {
+		hi = 0;
+	}
+	else if (rpm >= bp_rpm[GS_NUM_POINTS - 1]) {
+		lo = hi;
+	}
+	else {
+		// bp_rpm[lo] <= rpm < bp_rpm[hi]
+		while (hi - lo > 1) {
+			u8 mid = (lo + hi) >> 1;
+			if (bp_rpm[mid] <= rpm)
+				lo = mid;
+			else
+				hi = mid;
+		}
+	}
+
+	if (lo == hi) {
+		for (u8 j = 0; j < GS_NUM_GAINS; j++)
+			k[j] = bp_gain[lo][j];
+		return;
+	}
+
+	// slope * dx stays within gain << 16 because dx is less than the segment span
+	int32_t dx = rpm - bp_rpm[lo];
+	for (u8 j = 0; j < GS_NUM_GAINS; j++)
+		k[j] = bp_gain[lo][j] + ((slope_q16[lo][j] * dx + (1 << 15)) >> 16);
+}
+
+
+/**
+ * Prints the table as CSV over the UART
+ *
+ */
+void gs_report(void)
+{
+	xil_printf("GS,%s\r\n", enabled ? "on" : "off");
+	xil_printf("point,rpm,kp,ki,kd\r\n");
+
+	for (u8 i = 0; i < GS_NUM_POINTS; i++)
+		xil_printf("%d,%u,%u,%u,%u\r\n", i, bp_rpm[i], bp_gain[i][0], bp_gain[i][2], bp_gain[i][1]);
+}
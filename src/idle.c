@@ -0,0 +1,145 @@
+/****************************************************************************************
+*   @file idle.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Sleep-until-interrupt idle loop. See idle.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "idle.h"
+#include "system.h"
+#include "timebase.h"
+#include "scheduler.h"
+#include "xuartlite_l.h"
+#include "mb_interface.h"
+
+/***************************** Global variables ****************************/
+static volatile bool wake = false;		// an interrupt came in since the last idle_wait()
+static u8 console_task_id = SCHED_NO_TASK;
+
+/************************** Function Definitions ***************************/
+#ifndef HOST_BUILD
+/**
+ * Turns the UART Lite interrupt on. The console reads the FIFO itself, so only
+ * the enable bit is set and the driver's interrupt mode is not used
+ *
+ */
+static void uart_rx_enable(void)
+{
+	XUartLite_WriteReg(XPAR_UARTLITE_1_BASEADDR, XUL_CONTROL_REG_OFFSET, XUL_CR_ENABLE_INTR);
+}
+
+
+/**
+ * Timer interrupt: the alarm for the next release expired
+ *
+ */
+static void idle_timer_isr(void *ref)
+{
+	timebase_isr(ref);
+	wake = true;
+}
+
+
+/**
+ * UART interrupt: kicks the console task when data has arrived. The UART Lite
+ * also interrupts when its transmit FIFO empties, which only wakes the loop
+ *
+ */
+static void idle_uart_isr(void *ref)
+{
+	(void)ref;
+
+	if (!XUartLite_IsReceiveEmpty(XPAR_UARTLITE_1_BASEADDR))
+		sched_kick(console_task_id);
+	wake = true;
+}
+#endif
+
+
+/**
+ * Connects the timer and UART interrupts and enables them
+ *
+ * @param   intc        interrupt controller instance
+ * @param   uart_task   task index kicked when UART data arrives
+ *
+ * @return  XST_SUCCESS, or XST_FAILURE if the interrupt controller did not start
+ *
+ * @note    Call with interrupts disabled, before the main loop enables them
+ *
+ */
+XStatus idle_init(XIntc *intc, u8 uart_task)
+{
+	console_task_id = uart_task;
+	wake = false;
+
+#ifdef HOST_BUILD
+	(void)intc;
+	return XST_SUCCESS;
+#else
+	if (XIntc_Initialize(intc, INTC_DEVICE_ID) != XST_SUCCESS)
+		return XST_FAILURE;
+
+	if (XIntc_Connect(intc, TIMEBASE_INTR_ID, idle_timer_isr, NULL) != XST_SUCCESS ||
+		XIntc_Connect(intc, UART_INTR_ID, idle_uart_isr, NULL) != XST_SUCCESS)
+		return XST_FAILURE;
+
+	if (XIntc_Start(intc, XIN_REAL_MODE) != XST_SUCCESS)
+		return XST_FAILURE;
+
+	XIntc_Enable(intc, TIMEBASE_INTR_ID);
+	XIntc_Enable(intc, UART_INTR_ID);
+	microblaze_register_handler((XInterruptHandler)XIntc_InterruptHandler, intc);
+
+	uart_rx_enable();
+
+	return XST_SUCCESS;
+#endif
+}
+
+
+/**
+ * Sleeps until an interrupt or until_us, whichever comes first
+ *
+ * @param   until_us    next task release (sched_next_release_us())
+ *
+ * @note    Interrupts must be enabled. Returns at once if an interrupt came in
+ *          since the last call, so an event between the scheduler's last look
+ *          and here is not slept through
+ *
+ */
+void idle_wait(u32 until_us)
+{
+#ifdef HOST_BUILD
+	int32_t left = (int32_t)(until_us - timebase_now_us());
+
+	if (left > 0)
+		timebase_advance_us(left);
+#else
+	microblaze_disable_interrupts();
+
+	int32_t left = (int32_t)(until_us - timebase_now_us());
+
+	if (wake || left < IDLE_MIN_SLEEP_US) {
+		wake = false;
+		microblaze_enable_interrupts();
+		return;
+	}
+
+	timebase_set_alarm_us(left);
+
+#if IDLE_USE_MBAR
+	microblaze_enable_interrupts();
+	__asm__ volatile ("mbar 16");
+#else
+	microblaze_enable_interrupts();
+	while (!wake)
+		;
+#endif
+
+	wake = false;
+#endif
+}
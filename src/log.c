@@ -0,0 +1,80 @@
+/****************************************************************************************
+*   @file log.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Deferred logging ring buffer. See log.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "log.h"
+
+#if LOG_DEFERRED
+
+#include "timebase.h"
+
+/************************** Constant Definitions ***************************/
+#define LOG_RING_MASK	(LOG_RING_WORDS - 1)
+#define LOG_REC_WORDS(hdr)	(2 + (((hdr) >> 16) & 0x7))	// header, time, args
+
+/***************************** Global variables ****************************/
+static u32 ring[LOG_RING_WORDS];
+static u32 head = 0;			// next word written
+static u32 tail = 0;			// next word printed
+static u8 seq = 0;
+static u32 dropped = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Stores one record. The record is dropped if the ring is full
+ *
+ * @param   hdr     LOG_HDR() with the sequence number left at 0
+ * @param   args    the arguments counted in hdr
+ *
+ */
+void log_write(u32 hdr, const u32 *args)
+{
+	u32 n = (hdr >> 16) & 0x7;
+
+	if (LOG_RING_WORDS - (head - tail) < n + 2) {
+		dropped++;
+		seq++;
+		return;
+	}
+
+	ring[head++ & LOG_RING_MASK] = hdr | (u32)seq++ << 24;
+	ring[head++ & LOG_RING_MASK] = timebase_now_us();
+	for (u32 i = 0; i < n; i++)
+		ring[head++ & LOG_RING_MASK] = args[i];
+}
+
+
+/**
+ * Log task: prints up to LOG_FLUSH_RECORDS records as LOG,<hdr>,<time>,<args> lines
+ *
+ */
+void log_task(void)
+{
+	for (u8 r = 0; r < LOG_FLUSH_RECORDS && tail != head; r++) {
+		u32 len = LOG_REC_WORDS(ring[tail & LOG_RING_MASK]);
+
+		xil_printf("LOG");
+		for (u32 i = 0; i < len; i++)
+			xil_printf(",%08x", ring[tail++ & LOG_RING_MASK]);
+		xil_printf("\r\n");
+	}
+}
+
+
+/**
+ * Returns the number of records dropped because the ring was full
+ *
+ */
+u32 log_dropped(void)
+{
+	return dropped;
+}
+
+#endif
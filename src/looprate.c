@@ -0,0 +1,180 @@
+/****************************************************************************************
+*   @file looprate.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Control loop rate selection and gain rescaling. See looprate.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "looprate.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "sections.h"
+
+/************************** Constant Definitions ***************************/
+static const u32 rate_hz[LOOP_NUM_RATES] = { 5, 100, 500, 1000, 2000 };
+static const u32 rate_period_us[LOOP_NUM_RATES] = { 200000, 10000, 2000, 1000, 500 };
+
+/***************************** Global variables ****************************/
+static u8 control_task = SCHED_NO_TASK;
+static u8 cur_rate = LOOP_RATE_5HZ;
+static u32 last_tick_us = 0;
+static u32 last_dt_us = 0;
+static bool first_tick = true;
+
+static loop_gains_t gains;
+static u16 gains_kp, gains_ki, gains_kd;	// kpid the cached gains were computed from
+static bool gains_valid = false;
+static uint64_t dt_q32 = 0;					// gains.dt_us in seconds, Q32
+static uint64_t inv_dt_q16 = 0;				// 1 / gains.dt_us in 1/s, Q16
+
+/************************** Function Definitions ***************************/
+/**
+ * Sets up the rate selector
+ *
+ * @param   task_id     scheduler index of the control task
+ * @param   rate        initial LOOP_RATE_* value
+ *
+ */
+void looprate_init(u8 task_id, u8 rate)
+{
+	control_task = task_id;
+	cur_rate = 0xFF;
+	looprate_select(rate);
+}
+
+
+/**
+ * Changes the control loop rate
+ *
+ * @param   rate    LOOP_RATE_* value. Out of range values select the fastest rate
+ *
+ */
+void looprate_select(u8 rate)
+{
+	if (rate >= LOOP_NUM_RATES)
+		rate = LOOP_NUM_RATES - 1;
+
+	if (rate == cur_rate)
+		return;
+
+	cur_rate = rate;
+	sched_set_period(control_task, rate_period_us[rate]);
+
+	// the first tick at the new rate has no valid previous timestamp
+	first_tick = true;
+	gains_valid = false;
+}
+
+
+/**
+ * Returns the selected LOOP_RATE_* value
+ *
+ */
+u8 looprate_get(void)
+{
+	return cur_rate;
+}
+
+
+/**
+ * Returns the nominal period of the selected rate
+ *
+ */
+u32 looprate_period_us(void)
+{
+	return rate_period_us[cur_rate];
+}
+
+
+/**
+ * Returns the frequency in Hz of a LOOP_RATE_* value, 0 if out of range
+ *
+ */
+u32 looprate_hz(u8 rate)
+{
+	return (rate < LOOP_NUM_RATES) ? rate_hz[rate] : 0;
+}
+
+
+/**
+ * Measures the time since the previous control tick
+ *
+ * @return  the measured period in microseconds. The nominal period is returned
+ *          for the first tick after start-up or a rate change
+ *
+ * @note    Must be called exactly once at the start of every control tick
+ *
+ */
+HOT_CODE u32 looprate_tick(void)
+{
+	u32 now = timebase_now_us();
+
+	if (first_tick) {
+		last_dt_us = rate_period_us[cur_rate];
+		first_tick = false;
+	}
+	else {
+		last_dt_us = now - last_tick_us;
+		if (last_dt_us == 0)
+			last_dt_us = 1;
+	}
+
+	last_tick_us = now;
+
+	return last_dt_us;
+}
+
+
+/**
+ * Returns the period measured by the last looprate_tick()
+ *
+ */
+u32 looprate_last_dt_us(void)
+{
+	return last_dt_us;
+}
+
+
+/**
+ * Returns the discrete gains for the measured period
+ *
+ * @param   kp, ki, kd  continuous-time gains as set by the operator
+ *
+ * @return  pointer to the cached discrete gains
+ *
+ * @note    The period factors are divided out only when the period moves, a
+ *          change of kpid alone (every tick with gain scheduling on a ramp)
+ *          costs two multiplies
+ *
+ */
+HOT_CODE const loop_gains_t *looprate_gains(u16 kp, u16 ki, u16 kd)
+{
+	u32 dt = last_dt_us;
+	u32 tol = gains.dt_us >> 3;
+
+	bool dt_moved = (dt > gains.dt_us + tol) || (dt + tol < gains.dt_us);
+
+	if (!gains_valid || dt_moved) {
+		dt_q32 = ((uint64_t)dt << 32) / TIMEBASE_US_PER_SEC;
+		inv_dt_q16 = ((uint64_t)TIMEBASE_US_PER_SEC << 16) / dt;
+		gains.dt_us = dt;
+	}
+	else if (kp == gains_kp && ki == gains_ki && kd == gains_kd) {
+		return &gains;
+	}
+
+	gains.kp = kp;
+	gains.ki_dt_q16 = (int32_t)((ki * dt_q32) >> 16);
+	gains.kd_over_dt = (int32_t)((kd * inv_dt_q16) >> 16);
+
+	gains_kp = kp;
+	gains_ki = ki;
+	gains_kd = kd;
+	gains_valid = true;
+
+	return &gains;
+}
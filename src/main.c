@@ -13,7 +13,6 @@
 	#include <stdio.h>
 	#include <stdint.h>
 	#include <stdlib.h>
-	#include <math.h>
 	#include "platform.h"
 	#include "system.h"
 	#include "xparameters.h"
@@ -22,6 +21,29 @@
 	#include "nexys4io.h"
 	#include "xuartlite.h"
 	#include "xwdttb.h"
+	#include "timebase.h"
+	#include "scheduler.h"
+	#include "supervisor.h"
+	#include "fault.h"
+	#include "reversal.h"
+	#include "looprate.h"
+	#include "memmon.h"
+	#include "sections.h"
+	#include "console.h"
+	#include "log.h"
+	#include "flightrec.h"
+	#include "gainsched.h"
+	#include "observer.h"
+	#include "boottime.h"
+	#include "diag.h"
+	#include "status.h"
+	#include "pidcore.h"
+	#include "display.h"
+	#include "cpuload.h"
+	#include "idle.h"
+	#include "profile.h"
+	#include "scale.h"
+	#include "motorchar.h"
 
 
 	/********** Global Variables **********/
@@ -38,6 +60,28 @@
 	volatile u16 stptRPM_temp = 0;
 	bool newbtnsSw 			 = true;
 
+	// Console adjustable settings
+	u8 sp_src 				 = SP_SRC_ENCODER;	// where the RUN mode setpoint comes from
+	int16_t stpt_console 	 = 0;				// signed setpoint written from the console
+	u16 rpm_limit 			 = RPM_LIMIT_DEFAULT;	// setpoint clamp
+	u8 pwm_limit 			 = PWM_LIMIT_DEFAULT;	// controller output clamp
+	u8 loop_rate_sel 		 = LOOP_RATE_5HZ;
+	u8 fr_trig_src 			 = FR_TRIG_NONE;	// flight recorder trigger condition
+	u16 fr_trig_level 		 = 0;
+	u8 gs_src 				 = GS_SRC_SETPOINT;	// gain scheduling variable
+	u8 gs_bp_sel 			 = 0;				// breakpoint edited from the console
+	u16 gs_bp_rpm 			 = 0;
+	u8 obs_mode 			 = OBS_MODE_AUTO;	// speed feedback from the tach or the observer
+	u16 obs_k_q8 			 = OBS_DEFAULT_K_Q8;
+	u16 obs_tau_ms 			 = OBS_DEFAULT_TAU_US / 1000;
+	u16 obs_l_q8 			 = OBS_DEFAULT_L_Q16 >> 8;
+	bool pwm_saturated 		 = false;			// controller output clipped this tick
+	u16 rpm_meas 			 = 0;				// tach speed of the last control tick
+	u8 disp_page_sel 		 = 0;				// RUN mode display page
+	u8 disp_cycle_s 		 = 0;				// seconds per page, 0 for no cycling
+	u8 pwm_applied 			 = 0;				// duty cycle last written to the bridge
+	bool pid_tracking 		 = false;			// pid() ran on the previous control tick
+
 	XIntc 			INTC_Inst;		// Interrupt Controller instance
 
 	// Buttons and Switches Temp Variables
@@ -60,6 +104,8 @@
 	volatile int16_t rotaryCount;
 	XUartLite uart;
 	XWdtTb WDT_Inst;
+	PMODHB3 HB3_Inst;
+	PMODENC544 ENC_Inst;
 	u8 rpm = 1;
 
 	void input_task();
@@ -68,14 +114,160 @@
 	void run_task();
 	void crash_task();
 	void mode_task(void);
-	void pid(u8 kp_Sel, u8 ki_Sel, u8 kd_Sel, u8 pwmVal);
+	void wdt_task(void);
+	void btnsw_task(void);
+	void arm_supervisor(void);
+	void control_task(void);
+	void stop_task(void);
+	void release_tick(void);
+	u8 drive_bridge(bool on, u8 pwm);
+	void pid(u8 terms);
+	void apply_loop_rate(void);
+	void select_console_sp(void);
+	void cmd_stats(void);
+	void cmd_clear(void);
+	void cmd_reset(void);
+	void cmd_status(void);
+	void apply_fr_trigger(void);
+	void select_gs_point(void);
+	void apply_gs_rpm(void);
+	void apply_obs_model(void);
+	void cmd_diag(void);
+	void cmd_pidbench(void);
+	void cmd_play(void);
+	void cmd_char(void);
+	void char_tick(void);
+	void apply_char_result(void);
+	void status_task(void);
+	void display_task(void);
+	void apply_disp_page(void);
+	void apply_disp_cycle(void);
+	int32_t disp_rpm(void);
+	int32_t disp_stpt(void);
+	int32_t disp_duty(void);
+	int32_t disp_error(void);
+	int32_t disp_integ(void);
+	int32_t disp_period(void);
+	int32_t disp_fault(void);
+	int32_t disp_load(void);
+	void record_tick(int32_t stpt, int32_t rpm_signed, u8 pwm_out);
+
+	/********** Task Table **********/
+
+	// Task periods, offsets and budgets in microseconds. Priority 0 is the highest.
+	// The control task period is set at runtime by the loop rate selector
+	#define INPUT_TASK_PERIOD_US		10000
+	#define MODE_TASK_PERIOD_US		200000
+	#define MEMMON_TASK_PERIOD_US	1000000
+	#define CONSOLE_TASK_PERIOD_US	1000
+	#define LOG_TASK_PERIOD_US		100000
+	#define REC_TASK_PERIOD_US		10000
+	#define STATUS_TASK_PERIOD_US	50000
+	#define DISPLAY_TASK_PERIOD_US	100000
+	#define LOAD_TASK_PERIOD_US		1000000	// CPU load window
+	#define CHAR_TASK_PERIOD_US		10000
+	#define CONTROL_TASK_BUDGET_US	400
+
+	enum { TASK_CONTROL, TASK_INPUT, TASK_WDT, TASK_BTNSW, TASK_CONSOLE, TASK_MODE, TASK_MEMMON, TASK_REC, TASK_STATUS, TASK_DISPLAY, TASK_LOAD, TASK_CHAR,
+	#if LOG_DEFERRED
+		   TASK_LOG,
+	#endif
+		   NUM_TASKS };
+
+	sched_task_t task_table[NUM_TASKS] = {
+		//  name		function		period					offset	prio	budget
+		{ "control", control_task,	MODE_TASK_PERIOD_US,	0,		0,		CONTROL_TASK_BUDGET_US },
+		{ "input",	input_task,		INPUT_TASK_PERIOD_US,	0,		1,		500   },
+		{ "wdt",	wdt_task,		INPUT_TASK_PERIOD_US,	0,		2,		100   },
+		{ "btnsw",	btnsw_task,		INPUT_TASK_PERIOD_US,	0,		2,		100   },
+		{ "console", console_task,	CONSOLE_TASK_PERIOD_US,	0,		2,		500   },
+		{ "mode",	mode_task,		MODE_TASK_PERIOD_US,	5000,	3,		20000 },
+		{ "memmon",	memmon_task,	MEMMON_TASK_PERIOD_US,	7000,	4,		10000 },
+		{ "rec",	fr_task,		REC_TASK_PERIOD_US,		2000,	4,		12000 },
+		{ "status",	status_task,	STATUS_TASK_PERIOD_US,	4000,	4,		500   },
+		{ "display", display_task,	DISPLAY_TASK_PERIOD_US,	6000,	4,		2000  },
+		{ "load",	load_task,		LOAD_TASK_PERIOD_US,	8000,	4,		500   },
+		{ "char",	mchar_task,		CHAR_TASK_PERIOD_US,	9000,	4,		5000  },
+	#if LOG_DEFERRED
+		{ "log",	log_task,		LOG_TASK_PERIOD_US,		3000,	4,		5000  },
+	#endif
+	};
+
+	// sched_init() ignores the entries past SCHED_MAX_TASKS
+	_Static_assert(NUM_TASKS <= SCHED_MAX_TASKS, "task table larger than SCHED_MAX_TASKS");
+
+	/********** Console Tables **********/
+
+	// Parameters reachable from the UART console. The binary protocol id is the table index,
+	// so only ever append to this table
+	const console_param_t console_params[] = {
+		//  name		pointer				size	signed	min				max					on_set
+		{ "kp",		&kpid[0],			2,		false,	0,				255,				NULL },
+		{ "ki",		&kpid[2],			2,		false,	0,				255,				NULL },
+		{ "kd",		&kpid[1],			2,		false,	0,				255,				NULL },
+		{ "sp",		&stpt_console,		2,		true,	-RPM_LIMIT_DEFAULT, RPM_LIMIT_DEFAULT, select_console_sp },
+		{ "src",	&sp_src,			1,		false,	SP_SRC_ENCODER,	SP_SRC_STREAM,		NULL },
+		{ "lim",	&rpm_limit,			2,		false,	0,				RPM_LIMIT_DEFAULT,	NULL },
+		{ "pwmlim",	&pwm_limit,			1,		false,	0,				255,				NULL },
+		{ "mode",	&mode,				1,		false,	SET_MODE,		RUN_MODE,			arm_supervisor },
+		{ "rate",	&loop_rate_sel,		1,		false,	0,				LOOP_NUM_RATES - 1,	apply_loop_rate },
+		{ "trigsrc", &fr_trig_src,		1,		false,	FR_TRIG_NONE,	FR_TRIG_RPM,		apply_fr_trigger },
+		{ "triglvl", &fr_trig_level,	2,		false,	0,				INT16_MAX,			apply_fr_trigger },
+		{ "gssrc",	&gs_src,			1,		false,	GS_SRC_SETPOINT, GS_SRC_MEASURED,	NULL },
+		{ "gsbp",	&gs_bp_sel,			1,		false,	0,				GS_NUM_POINTS - 1,	select_gs_point },
+		{ "gsrpm",	&gs_bp_rpm,			2,		false,	0,				RPM_LIMIT_DEFAULT,	apply_gs_rpm },
+		{ "obs",	&obs_mode,			1,		false,	OBS_MODE_OFF,	OBS_MODE_AUTO,		NULL },
+		{ "obsk",	&obs_k_q8,			2,		false,	1,				UINT16_MAX,			apply_obs_model },
+		{ "obstau",	&obs_tau_ms,		2,		false,	1,				10000,				apply_obs_model },
+		{ "obsl",	&obs_l_q8,			2,		false,	0,				256,				apply_obs_model },
+		{ "dpage",	&disp_page_sel,		1,		false,	0,				DISP_MAX_PAGES - 1,	apply_disp_page },
+		{ "dpcycle", &disp_cycle_s,		1,		false,	0,				60,					apply_disp_cycle },
+	};
+
+	const console_cmd_t console_cmds[] = {
+		{ "stats",	cmd_stats },
+		{ "mem",	memmon_report },
+		{ "status",	cmd_status },
+		{ "clear",	cmd_clear },
+		{ "reset",	cmd_reset },
+		{ "rec",	fr_dump_start },
+		{ "arm",	fr_arm },
+		{ "trig",	fr_trigger },
+		{ "gains",	gs_report },
+		{ "boot",	boot_report },
+		{ "diag",	cmd_diag },
+		{ "pidbench", cmd_pidbench },
+		{ "load",	load_report },
+		{ "play",	cmd_play },
+		{ "pstop",	prof_stop },
+		{ "pclear",	prof_clear },
+		{ "prof",	prof_report },
+		{ "char",	cmd_char },
+		{ "charrep", mchar_report },
+		{ "chardump", mchar_dump_start },
+	};
+
+	/********** Display Pages **********/
+
+	// RUN mode seven-segment pages, selected with BTNU/BTND. Append only, the
+	// page number shown on digit 7 is the index + 1
+	const disp_page_t disp_pages[] = {
+		//  format			value			digits 3-0
+		{ DISP_FMT_PAIR,	disp_rpm,		disp_stpt },	// actual RPM, setpoint RPM
+		{ DISP_FMT_VALUE,	disp_duty,		NULL },			// PWM duty cycle, 0-255
+		{ DISP_FMT_VALUE,	disp_error,		NULL },			// controller error
+		{ DISP_FMT_VALUE,	disp_integ,		NULL },			// integrator
+		{ DISP_FMT_VALUE,	disp_period,	NULL },			// measured loop period, us
+		{ DISP_FMT_VALUE,	disp_fault,		NULL },			// fault code
+		{ DISP_FMT_VALUE,	disp_load,		NULL },			// CPU load, 0.1 %
+	};
 
 
 	/***********Main Program***********/
 	int main()
 	{
-	   xil_printf("ECE 544 Nexys4IO Project-2 Application\r\n");
-	   xil_printf("By Omkar Jadhav, Supreet Gulavani\r\n");
+	   // Paint the stack and heap before anything else runs so the high-water marks cover boot
+	   memmon_init();
 
 	   init_platform();
 	   u32 sts = do_init();
@@ -86,31 +278,44 @@
 			return 1;
 		}
 
+		// The motor is already in a safe state, the banners can wait until now
+		xil_printf("ECE 544 Nexys4IO Project-2 Application\r\n");
+		xil_printf("By Omkar Jadhav, Supreet Gulavani\r\n");
+		boot_report();
+
+		xil_printf("Last reset: %s, boot #%u\r\n", sup_cause_str(sup_reset_cause()), sup_boot_count());
+		if (sup_reset_cause() == SUP_CAUSE_DEADLINE)
+			xil_printf("Channel %d missed its deadline\r\n", sup_failed_channel());
+		if (fr_frozen())
+			xil_printf("Flight recording held (cause %d, %d samples), \"rec\" dumps it\r\n",
+					   fr_cause(), fr_count());
+
 		microblaze_disable_interrupts();
 
-		// main loop
+		sched_init(task_table, NUM_TASKS);
+		sched_set_post_hook(memmon_sample);
+		load_init();
+		looprate_init(TASK_CONTROL, loop_rate_sel);
+		arm_supervisor();
+		console_init(&uart, console_params, sizeof(console_params) / sizeof(console_params[0]),
+					 console_cmds, sizeof(console_cmds) / sizeof(console_cmds[0]));
+		prof_init();
+		console_set_stream(prof_stream);
+		disp_init(disp_pages, sizeof(disp_pages) / sizeof(disp_pages[0]));
+
+		bool can_sleep = (idle_init(&INTC_Inst, TASK_CONSOLE) == XST_SUCCESS);
+		if (!can_sleep)
+			LOG_WARN(SYS, "Interrupts not available, the idle loop polls\r\n");
+		microblaze_enable_interrupts();
+
+		/* main loop - the scheduler releases each task on its own period.
+		 * With nothing due the processor sleeps until the next release or
+		 * until UART data arrives
+		 */
 		while (1)
 		{
-		   input_task();
-
-		   if (XWdtTb_IsWdtExpired(&WDT_Inst))
-		   {
-			   if (encSW_temp == 0)
-			   {
-					XWdtTb_RestartWdt(&WDT_Inst);
-			   }
-		   }
-
-		   if (newbtnsSw)
-		   {
-			   update_btnsw_val();
-			   newbtnsSw = false;
-		   }
-
-		   mode_task();
-
-		   if (mode != RUN_MODE)
-			   usleep(500000);
+		   if (!sched_dispatch() && can_sleep)
+			   idle_wait(sched_next_release_us());
 		}
 
 	   // say goodbye and exit - should never reach here
@@ -149,7 +354,7 @@
 		btn_temp = NX4IO_getBtns ();
 
 		// Get the values of the encoder button and switches
-		u32 encBtnSW_temp = PMODENC544_getBtnSwReg();
+		u32 encBtnSW_temp = PMODENC544_getBtnSwReg(&ENC_Inst);
 		encBtn_temp = encBtnSW_temp & 0x01;
 		encSW_temp = (encBtnSW_temp >>1) & 0x01;
 
@@ -167,6 +372,59 @@
 
 	}
 
+	/**
+	 * wdt_task() - Services the watchdog timer
+	 *
+	 * @brief The supervisor only restarts the watchdog while every armed critical
+	 * 		  channel has checked in on time.
+	 */
+	void wdt_task(void)
+	{
+		sup_service();
+	}
+
+	/**
+	 * arm_supervisor() - Selects the critical channels for the current mode
+	 *
+	 * @brief In RUN and CRASH mode sampling, control and actuation all have to check in.
+	 * 		  In SET mode the motor is not driven, once the release ramp is done, so only
+	 * 		  the control channel is supervised.
+	 * 		  The control task checks in every loop period, so its channels get a deadline
+	 * 		  of a few periods. In SET mode the mode task checks the control channel in.
+	 */
+	void arm_supervisor(void)
+	{
+		u32 deadline = SUP_DEADLINE_PERIODS * looprate_period_us();
+		if (deadline < SUP_MIN_DEADLINE_US)
+			deadline = SUP_MIN_DEADLINE_US;
+
+		sup_set_deadline(SUP_CH_SAMPLE, deadline);
+		sup_set_deadline(SUP_CH_ACTUATE, deadline);
+
+		if ((mode == SET_MODE && pwm_applied == 0) || mode == DIAG_MODE) {
+			sup_set_deadline(SUP_CH_CONTROL, SUP_DEFAULT_DEADLINE_US);
+			sup_arm(SUP_MASK(SUP_CH_CONTROL));
+		}
+		else {
+			sup_set_deadline(SUP_CH_CONTROL, deadline);
+			sup_arm(SUP_MASK_ALL);
+		}
+	}
+
+	/**
+	 * btnsw_task() - Applies new button and switch values
+	 *
+	 * @brief Hands the values captured by input_task() to update_btnsw_val() when they changed
+	 */
+	void btnsw_task(void)
+	{
+		if (newbtnsSw)
+		{
+		   update_btnsw_val();
+		   newbtnsSw = false;
+		}
+	}
+
 	/**
 	 * update_btnsw_val() - Switch between modes
 	 *
@@ -174,6 +432,7 @@
 	 */
 	void update_btnsw_val()
 	{
+		static u8 btn_last = 0;
 
 		btn		=  btn_temp;
 		sw		=  sw_temp;
@@ -184,16 +443,49 @@
 		 * If yes, change the mode between SET_MODE and RUN_MODE
 		 */
 		if(GET_BIT(btn,4)){
-		   mode++;
-		   if(mode > 1)
+		   /* With the drive stopped or latched by a fault, the center
+		    * button acknowledges the fault and returns to SET_MODE
+		    */
+		   if (fault_state() >= FAULT_ST_STOPPED) {
+			   fault_clear();
+			   integralVal = 0;
 			   mode = SET_MODE;
+		   }
+		   else {
+			   mode++;
+			   if(mode > 1)
+				   mode = SET_MODE;
+		   }
 		}
 
+		/* In RUN mode buttons U and D page through the display,
+		 * once per press
+		 */
+		if (mode == RUN_MODE) {
+		   u8 pressed = btn & ~btn_last;
+		   if (GET_BIT(pressed,3))
+			   disp_next();
+		   else if (GET_BIT(pressed,2))
+			   disp_prev();
+		}
+		btn_last = btn;
+
 		/* Check if the encoder switch is pushed to ON
 		 * If yes, change the mode to CRASH_MODE
 		 */
 		if (GET_BIT(encSW,0))
 		   mode = CRASH_MODE;
+
+		arm_supervisor();
+
+		/* Switches [15:13] select the control loop rate
+		 * 0 -> 5 Hz, 1 -> 100 Hz, 2 -> 500 Hz, 3 -> 1 kHz, 4 and up -> 2 kHz
+		 */
+		loop_rate_sel = (sw >> 13) & 0x7;
+		apply_loop_rate();
+
+		// Switch 12 turns gain scheduling on, seeded from kpid the first time
+		gs_set_enabled(GET_BIT(sw, SW_GS_ENABLE), kpid);
 	}
 
 	/**
@@ -207,7 +499,12 @@
 	{
 		uint8_t param_temp = sel_k_params;
 
-		xil_printf("\n\r//////////////SET TASK////////////////\n\r");
+		/* With gain scheduling on the buttons edit the breakpoint selected by
+		 * switches [11:9] instead of the fixed gains
+		 */
+		u16 *k = gs_enabled() ? gs_point_gains(SW_GS_POINT(sw)) : kpid;
+
+		LOG_DEBUG(UI, "\n\r//////////////SET TASK////////////////\n\r");
 
 		/* check if the switches [6:5] are pressed.
 		 * Update the factors of Kp, Ki, Kd accordingly.
@@ -241,7 +538,13 @@
 			   break;
 		}
 
-		xil_printf("Btn R: %d Btn U: %d Btn D: %d Btn L:%d\n\r", GET_BIT(btn,0), GET_BIT(btn,3), GET_BIT(btn,2), GET_BIT(btn,1));
+		LOG_DEBUG(UI, "Btn R: %d Btn U: %d Btn D: %d Btn L:%d\n\r", GET_BIT(btn,0), GET_BIT(btn,3), GET_BIT(btn,2), GET_BIT(btn,1));
+
+		// Button L dumps the scheduler statistics and stack usage
+		if (GET_BIT(btn,1)) {
+		   sched_report();
+		   memmon_report();
+		}
 
 		/* Kx parameters modifications
 		 * If the button R is pressed, select between Kp, Ki, Kd, to
@@ -263,12 +566,12 @@
 		if (GET_BIT(btn,3)) {
 		   u16 temp;
 
-		   temp = kpid[sel_k_params] + k_param_change;
+		   temp = k[sel_k_params] + k_param_change;
 
 		   if(temp > 255)
-			   kpid[sel_k_params] = 255;
+			   k[sel_k_params] = 255;
 		   else
-			   kpid[sel_k_params] = temp;
+			   k[sel_k_params] = temp;
 		}
 
 		/* Kx parameters modifications
@@ -277,30 +580,33 @@
 		else if (GET_BIT(btn,2)) {
 		   int16_t temp;
 
-		   temp = kpid[sel_k_params] - k_param_change;
+		   temp = k[sel_k_params] - k_param_change;
 
 		   if (temp < 0)
-			   kpid[sel_k_params] = 0;
+			   k[sel_k_params] = 0;
 		   else
-			   kpid[sel_k_params] = temp;
+			   k[sel_k_params] = temp;
 		}
 
+		if (gs_enabled() && (GET_BIT(btn,3) || GET_BIT(btn,2)))
+		   gs_update();
+
 		/* Display the kp, ki, kd values on to the 7 segment display
 		 * Digit[1:0] -> kd
 		 * Digit[3:2] -> ki
 		 * Digit[5:4] -> kp
+		 * Digit[7]	  -> breakpoint being edited, with gain scheduling on
 		 */
-		NX410_SSEG_setAllDigits(SSEGLO, (kpid[1] / 10) % 10, kpid[1] % 10,
-										(kpid[2] / 10) % 10, kpid[2] % 10,
+		NX410_SSEG_setAllDigits(SSEGLO, (k[1] / 10) % 10, k[1] % 10,
+										(k[2] / 10) % 10, k[2] % 10,
 										(GET_BIT(sw, 1) << 3 | GET_BIT(sw, 0) << 1));
-		usleep(100);
 
-		NX410_SSEG_setAllDigits(SSEGHI, CC_BLANK		   , CC_BLANK,
-										(kpid[0] / 10) % 10, kpid[0] % 10,
+		NX410_SSEG_setAllDigits(SSEGHI, gs_enabled() ? SW_GS_POINT(sw) : CC_BLANK, CC_BLANK,
+										(k[0] / 10) % 10, k[0] % 10,
 										GET_BIT(sw,2) << 1);
 
-		xil_printf("k_param_change: %d, set_pt_mod: %d, sel_k_params: %d, kpid[sel_k_params]: %d \n\r", k_param_change, set_pt_mod, sel_k_params,
-						   kpid[sel_k_params]);
+		LOG_DEBUG(UI, "k_param_change: %d, set_pt_mod: %d, sel_k_params: %d, k[sel_k_params]: %d \n\r", k_param_change, set_pt_mod, sel_k_params,
+						   k[sel_k_params]);
 	}
 
 	/**
@@ -311,27 +617,47 @@
 	 */
 	void run_task()
 	{
-		u8 pwmVal;
+		/* A streamed profile is followed by pid() on every tick. Only the
+		 * copy of the setpoint shown on the display is kept up to date here,
+		 * and the integrator is left running through the profile
+		 */
+		if (sp_src == SP_SRC_STREAM) {
+			int32_t sp = prof_current();
+			stptRPM = abs(sp);
+			direction = (sp >= 0);
+			return;
+		}
 
-		// Get the rotary count from the encoder
-		rotaryCount = PMODENC544_getRotaryCount()  * set_pt_mod;
+		if (sp_src == SP_SRC_ENCODER) {
+			// Get the rotary count from the encoder
+			rotaryCount = PMODENC544_getRotaryCount(&ENC_Inst)  * set_pt_mod;
 
 
-		xil_printf("rotary_count:%d Setting rpm:%d set_pt_mod: %d\n\r", 1, rotaryCount, set_pt_mod);
+			LOG_DEBUG(UI, "rotary_count:%d set_pt_mod: %d\n\r", rotaryCount, set_pt_mod);
 
-		// Convert the rotary count to RPM
-		stptRPM_temp = abs(rotaryCount) * 6000/ 255;
+			// Convert the rotary count to RPM
+			stptRPM_temp = scale_pwm_to_rpm(abs(rotaryCount));
 
-		// Determine the direction
-		if (rotaryCount > 0) {
-		   direction = 1;
+			// Determine the direction
+			if (rotaryCount > 0) {
+			   direction = 1;
+			}
+			else if (rotaryCount < 0)
+			   direction = 0;
+		}
+		else {
+			// Setpoint written over the UART console
+			stptRPM_temp = abs(stpt_console);
+
+			if (stpt_console > 0)
+			   direction = 1;
+			else if (stpt_console < 0)
+			   direction = 0;
 		}
-		else if (rotaryCount < 0)
-		   direction = 0;
 
 		// Restrict the setpoint RPM
-		if (stptRPM_temp > 5000) {
-		   stptRPM_temp = 5000;
+		if (stptRPM_temp > rpm_limit) {
+		   stptRPM_temp = rpm_limit;
 		}
 
 		// Ensure that the RPM is non negative
@@ -340,14 +666,11 @@
 		}
 
 		/* check if a new setpoint is assigned.
-		 * Display on the rpm on Digit [3:0]
+		 * The display task shows it on Digit [3:0] of the RPM page.
 		 * Map the rotary Count from 0  to 255.
 		 * For each setpoint, update the integral value to 0 for the PID controller.
 		 */
 		if (stptRPM_temp != stptRPM) {
-		   NX410_SSEG_setAllDigits(SSEGLO, (stptRPM_temp / 1000) % 10, (stptRPM_temp / 100) % 10, (stptRPM_temp / 10) % 10, stptRPM_temp % 10, DP_NONE);
-		   pwmVal = (u8)fmin(abs(rotaryCount), 255);
-
 		   stptRPM =  stptRPM_temp;
 		   integralVal = 0;
 		}
@@ -358,33 +681,203 @@
 
 		if(!rpm)
 		   stptRPM = 0;
-
-		pid(GET_BIT(sw,2), GET_BIT(sw, 1), GET_BIT(sw, 0), pwmVal);
-
 	}
 
 	/**
 	 * crash_task() - handles all the CRASH mode configurations
 	 *
-	 * @brief The function when encoder switch is toggled, sets all the parameters to zero.
+	 * @brief The function when encoder switch is toggled, raises a latched fault.
+	 * 		  stop_task() then ramps the motor down through the fault manager. Turning the
+	 * 		  encoder switch off and pressing the center button recovers without a power cycle.
 	 *
 	 */
 	void crash_task()
 	{
-		xil_printf("\n\r///////////CRASH MODE/////////////\n\r");
+		if (fault_code() != FAULT_USER) {
+			LOG_WARN(FAULT, "\n\r///////////CRASH MODE/////////////\n\r");
 
-		// Set all important parameters to zero
-		btn 	= 0;
-		sw 		= 0;
-		encBtn 	= 0;
-		encSW 	= 0;
+			// Set all important parameters to zero
+			btn 	= 0;
+			sw 		= 0;
+			encBtn 	= 0;
+			encSW 	= 0;
+			integralVal = 0;
 
-		// Display ECE 540 on the 7 seg display
-		NX4IO_SSEG_setSSEG_DATA(SSEGHI, 0x0058E30E);
-		NX4IO_SSEG_setSSEG_DATA(SSEGLO, 0x00144116);
+			// Display ECE 540 on the 7 seg display
+			NX4IO_SSEG_setSSEG_DATA(SSEGHI, 0x0058E30E);
+			NX4IO_SSEG_setSSEG_DATA(SSEGLO, 0x00144116);
+
+			fault_raise(FAULT_USER);
+		}
+	}
+
+	/**
+	 * drive_bridge() - Writes the enable, direction and duty cycle to the H-bridge
+	 *
+	 * @brief Every actuation path goes through here. Once the supervisor has requested
+	 * 		  a reset the bridge is held disabled at PWM 0, even if the caller is still
+	 * 		  running.
+	 *
+	 * @return	duty cycle now on the bridge, 0 if it is disabled
+	 *
+	 */
+	HOT_CODE u8 drive_bridge(bool on, u8 pwm)
+	{
+		if (!on || !sup_actuation_allowed()) {
+			on = false;
+			pwm = 0;
+		}
+
+		PMODHB3_SetConfig(&HB3_Inst, (on << 9 | reversal_dir_bit() << 8 | pwm));
+		return pwm;
+	}
+
+	/**
+	 * stop_task() - Brings the motor to a stop in CRASH mode
+	 *
+	 * @brief Keeps stepping the fault manager at the control rate so the motor ramps down.
+	 *
+	 */
+	void stop_task(void)
+	{
+		u8 pwm_out = fault_step(0, false, looprate_tick(), 0);
+		sup_checkin(SUP_CH_SAMPLE);
+		sup_checkin(SUP_CH_CONTROL);
 
-		// Infinite loop
-		while(1);
+		pwm_applied = drive_bridge(fault_bridge_enabled(), pwm_out);
+		sup_checkin(SUP_CH_ACTUATE);
+
+		// Keep recording the ramp-down
+		u32 rpm_raw = PMODHB3_GetRpm(&HB3_Inst);
+		record_tick(0, reversal_signed_rpm(rpm_raw), pwm_out);
+	}
+
+	/**
+	 * release_tick() - Ramps the output down once RUN mode is left
+	 *
+	 * @brief The controller does not run in SET mode. Rather than leave its last duty
+	 * 		  cycle on the bridge, or cut it in one step, the output ramps to zero at
+	 * 		  RELEASE_RAMP_PWM_PER_S. Going back to RUN mode carries on from the ramp.
+	 * 		  While the ramp drives the bridge it is handled like a control tick: every
+	 * 		  supervisor channel is armed and checked in, the fault manager and the
+	 * 		  reversal sequencer gate the output and the tick is recorded. Once the
+	 * 		  output is at zero the supervisor goes back to the SET mode channels.
+	 *
+	 */
+	void release_tick(void)
+	{
+		static u16 out_q8 = 0;			// ramped output, Q8 so slow loop rates still move
+
+		u32 dt_us = looprate_tick();
+
+		if (pwm_applied == 0)
+			return;
+
+		PMODHB3_Sample tach;
+		bool fresh = PMODHB3_PollNewSample(&HB3_Inst, &tach);
+		sup_checkin(SUP_CH_SAMPLE);
+
+		if ((out_q8 >> 8) != pwm_applied)
+			out_q8 = (u16)pwm_applied << 8;
+
+		u32 step_q8 = dt_us * (RELEASE_RAMP_PWM_PER_S * 256 / 1000) / 1000;
+		out_q8 = (out_q8 > step_q8) ? out_q8 - step_q8 : 0;
+
+		u8 pwm_out = fault_step(tach.rpm, fresh, dt_us, out_q8 >> 8);
+		sup_checkin(SUP_CH_CONTROL);
+
+		bool bridge_on = fault_bridge_enabled() && reversal_bridge_enabled();
+		pwm_applied = drive_bridge(bridge_on, pwm_out);
+		sup_checkin(SUP_CH_ACTUATE);
+
+		obs_input(reversal_sign() * pwm_applied);
+		record_tick(0, reversal_signed_rpm(tach.rpm), pwm_out);
+
+		if (pwm_applied == 0)
+			arm_supervisor();
+	}
+
+	/**
+	 * char_tick() - Runs the motor characterization at the control rate
+	 *
+	 * @brief Open loop: the characterization picks the PWM from the tach readings. The
+	 * 		  fault manager is bypassed, its stall and overspeed limits would stop the
+	 * 		  staircase at the low and high levels. Not recorded by the flight recorder.
+	 *
+	 */
+	void char_tick(void)
+	{
+		looprate_tick();
+
+		PMODHB3_Sample tach;
+		bool fresh = PMODHB3_PollNewSample(&HB3_Inst, &tach);
+		sup_checkin(SUP_CH_SAMPLE);
+
+		u8 pwm_out = mchar_step(tach.rpm, fresh, timebase_now_us());
+		sup_checkin(SUP_CH_CONTROL);
+
+		pwm_applied = drive_bridge(true, pwm_out);
+		sup_checkin(SUP_CH_ACTUATE);
+
+		rpm_meas = (tach.rpm > 0xFFFF) ? 0xFFFF : tach.rpm;
+
+		status_snap_t *st = status_snapshot();
+		st->error 		= 0;
+		st->pwm 		= pwm_out;
+		st->saturated 	= false;
+	}
+
+	/**
+	 * record_tick() - Stores this control tick in the flight recorder
+	 *
+	 * @brief A handful of stores into the recorder slot. The recorder freezes itself
+	 * 		  when the fault manager confirms a fault, so the lead-up through DEGRADED
+	 * 		  is kept. Only the step into RAMP_DOWN or beyond triggers it, so an arm
+	 * 		  while the fault is still latched waits for the next fault.
+	 *
+	 */
+	HOT_CODE void record_tick(int32_t stpt, int32_t rpm_signed, u8 pwm_out)
+	{
+		static u8 fault_prev = FAULT_ST_RUNNING;
+		u8 fault_now = fault_state();
+		fr_sample_t *s = fr_next();
+
+		s->t_us 	= timebase_now_us();
+		s->stpt 	= fr_sat16(stpt);
+		s->rpm 		= fr_sat16(rpm_signed);
+		s->error 	= fr_sat16(error);
+		s->integ 	= fr_sat16(integralVal);
+		s->sw 		= sw;
+		s->pwm 		= pwm_out;
+		s->btn 		= (btn & 0x1F) | (encBtn & 0x1) << 5 | (encSW & 0x1) << 6;
+		s->status 	= FR_STATUS(mode, reversal_dir_bit(), reversal_state(), fault_now);
+		s->fault 	= fault_code();
+		s->dt_us 	= (looprate_last_dt_us() > 0xFFFF) ? 0xFFFF : looprate_last_dt_us();
+
+		fr_commit(fault_now >= FAULT_ST_RAMP_DOWN && fault_prev < FAULT_ST_RAMP_DOWN);
+		fault_prev = fault_now;
+
+		status_snap_t *st = status_snapshot();
+		st->error 		= s->error;
+		st->pwm 		= pwm_out;
+		st->saturated 	= pwm_saturated;
+	}
+
+	/**
+	 * status_task() - Shows the controller status on the RGB LEDs and the LED bar
+	 */
+	void status_task(void)
+	{
+		status_render(mode);
+	}
+
+	/**
+	 * display_task() - Shows the selected page on the 7 segment display in RUN mode
+	 */
+	void display_task(void)
+	{
+		disp_task(mode == RUN_MODE || mode == CHAR_MODE);
+		disp_page_sel = disp_page();
 	}
 
 	/**
@@ -395,10 +888,19 @@
 	 */
 	void mode_task(void)
 	{
+	   // Leaving CHAR mode early (BTNC, CRASH mode, the console) stops the motor
+	   if (mode != CHAR_MODE && mchar_running()) {
+		   mchar_abort();
+		   sup_safe_state();
+		   pwm_applied = 0;
+		   apply_loop_rate();
+	   }
+
 	   // Operate between modes
 	   switch(mode) {
 		   case SET_MODE:
 			   set_task();
+			   sup_checkin(SUP_CH_CONTROL);
 			   break;
 		   case RUN_MODE:
 			   run_task();
@@ -406,76 +908,470 @@
 		   case CRASH_MODE:
 			   crash_task();
 			   break;
+		   case DIAG_MODE:
+			   // One peripheral per pass, back to SET mode when done
+			   if (diag_step()) {
+				   // start the tach sample tracking over from what the self-test left
+				   PMODHB3_Initialize(&HB3_Inst, XPAR_PMODHB3_IP_0_S00_AXI_BASEADDR);
+				   PMODENC544_clearRotaryCount(&ENC_Inst);
+				   status_init();
+				   mode = SET_MODE;
+				   arm_supervisor();
+			   }
+			   sup_checkin(SUP_CH_CONTROL);
+			   break;
+		   case CHAR_MODE:
+			   // The control task runs the staircase, back to SET mode once it is fitted
+			   if (!mchar_running()) {
+				   if (mchar_state() == MCHAR_DONE)
+					   apply_char_result();
+				   mchar_report();
+				   mode = SET_MODE;
+				   arm_supervisor();
+				   apply_loop_rate();
+			   }
+			   break;
 		   default:
 			   break;
 	   }
 	}
 
+	/**
+	 * control_task() - Runs the control loop at the selected loop rate
+	 *
+	 * @brief Calls the P/I/D controller in RUN mode and the ramp-down in CRASH mode.
+	 * 		  In SET mode the output left by RUN mode ramps down.
+	 *
+	 */
+	HOT_CODE void control_task(void)
+	{
+		boot_first_tick();
+
+		// pid() picks up from the bridge output when RUN mode is entered again
+		if (mode != RUN_MODE)
+			pid_tracking = false;
+
+		switch(mode) {
+			case RUN_MODE:
+				pid(sw & (PID_TERM_P | PID_TERM_I | PID_TERM_D));
+				break;
+			case SET_MODE:
+				release_tick();
+				break;
+			case CRASH_MODE:
+				if (fault_code() == FAULT_USER)
+					stop_task();
+				break;
+			case CHAR_MODE:
+				char_tick();
+				break;
+			default:
+				break;
+		}
+	}
+
 	/**
 	 * pid() - Drives the motor based on P/I/D controller
 	 *
-	 * @brief Initializes the pid if uninitialized by setting the motor to a high value.
+	 * @brief Initializes the pid if uninitialized by kicking the motor with the duty cycle
+	 * 		  that gets it turning (the characterized deadband, 0x1f until then).
 	 * 		  Captures the rpm of the motor and passes the P/I/D control to the motor.
+	 * 		  The I and D terms use the period measured for this tick.
+	 *
+	 * @param	terms	P/I/D enables from sw[2:0] (PID_TERM_*)
 	 *
 	 */
-	void pid(u8 kp_Sel, u8 ki_Sel, u8 kd_Sel, u8 pwmVal)
+	HOT_CODE void pid(u8 terms)
 	{
 		static bool pid_IsInitialized = false;
-		static  float time_step = 0.01f;
+		static u8 terms_last = 0;			// law and gains of the previous tick
+		static loop_gains_t g_last;
+		static u16 k_last[3];				// operator gains, schedule and rate of the previous tick
+		static bool gs_last = false;
+		static u8 rate_last = 0;
+
+		int32_t pwm_actual, pwm_target, pwm_calc;
+		u8 pwm_new;
 
-		u8 pwm_actual, pwm_new, pwm_target;
+		looprate_tick();
 
 		// check if pid is not intialized
 		if (!pid_IsInitialized)
 		{
 		   // Send the first rpm to the motor
-		   PMODHB3_SetConfig(XPAR_PMODHB3_IP_0_S00_AXI_BASEADDR, PMODHB3_IP_S00_AXI_SLV_REG1_OFFSET,
-				   	   	   	   (1 << 9 | direction << 8 | 0x1f));
+		   pwm_applied = drive_bridge(true, mchar_start_pwm());
 		   pid_IsInitialized = true;
 
+		   sup_checkin(SUP_CH_SAMPLE);
+		   sup_checkin(SUP_CH_CONTROL);
+		   sup_checkin(SUP_CH_ACTUATE);
+
 		   return;
 		}
 
 		int32_t prev_error = error;
 
-		// Delay to let hardware accumulate pulses for calculating rpm
-		usleep(200000);
+		/* Capture the rpm. The tach only updates once per counting window; the
+		 * driver tells us whether this reading is a new one
+		 */
+		PMODHB3_Sample tach;
+		bool fresh = PMODHB3_PollNewSample(&HB3_Inst, &tach);
+		u32 rpm_raw = tach.rpm;
+		u16 rpm_actual = (rpm_raw > 0xFFFF) ? 0xFFFF : rpm_raw;
+		sup_checkin(SUP_CH_SAMPLE);
+
+		/* The controller works in signed velocity. A change of sign in the setpoint
+		 * goes through the reversal sequencer, which brings the motor to a stop
+		 * before the direction bit is flipped.
+		 */
+		int32_t stpt_signed = (sp_src == SP_SRC_STREAM) ? prof_setpoint(rpm_limit) :
+							  direction ? (int32_t)stptRPM : -(int32_t)stptRPM;
+		int32_t stpt_eff = reversal_step(stpt_signed, rpm_actual, looprate_last_dt_us());
+		int32_t rpm_signed = reversal_signed_rpm(rpm_actual);
+
+		/* Between tach readings the observer predicts the speed from the PWM applied.
+		 * SET mode keeps the loop rate ticking but not the observer, so on entering
+		 * RUN mode its estimate is the one left from the last stay in RUN. Restart it
+		 * from the tach before the bumpless transfer below works from it
+		 */
+		if (!pid_tracking)
+			obs_reset(rpm_signed);
+		int32_t rpm_est = obs_step(looprate_last_dt_us(), rpm_signed, fresh);
+		bool use_obs = (obs_mode == OBS_MODE_ON) ||
+					   (obs_mode == OBS_MODE_AUTO && looprate_period_us() < OBS_TACH_WINDOW_US);
+		int32_t rpm_fb = use_obs ? rpm_est : rpm_signed;
+
+		pwm_actual = scale_rpm_to_pwm(rpm_fb);
+		pwm_target = scale_rpm_to_pwm(stpt_eff);
+
+		// the display task shows the captured rpm on Digit[7:4]
+		rpm_meas = rpm_actual;
+
+		// Calculate the error between the setpoint and rpm detected from digital encoder
+		error = pwm_target - pwm_actual;
+
+		// Calculate the rpm with the selected control law, with gains scaled for the measured period
+		const u16 *k = kpid;
+		u16 k_sched[GS_NUM_GAINS];
+		if (gs_enabled()) {
+			gs_gains((gs_src == GS_SRC_MEASURED) ? rpm_actual : (u16)abs(stpt_eff), k_sched);
+			k = k_sched;
+		}
+		const loop_gains_t *g = looprate_gains(k[0], k[2], k[1]);
+
+		/* Bumpless transfer. On entering RUN mode the integrator is set so the
+		 * output carries on from the duty cycle on the bridge, with no derivative
+		 * kick. When the P/I/D switches, the operator gains, the gain schedule switch
+		 * or the loop rate change, it is set so the new law gives what the old one
+		 * would have. The scheduled gains and the measured period move the discrete
+		 * gains on many ticks but only by small steps, so they do not trigger it;
+		 * pid_bumpless() divides and stays off the per-tick path
+		 */
+		bool gs_on = gs_enabled();
+		u8 rate = looprate_get();
 
-		// Capture the rpm
-		u16 rpm_actual = PMODHB3_GetRpm(XPAR_PMODHB3_IP_0_S00_AXI_BASEADDR,
-							PMODHB3_IP_S00_AXI_SLV_REG0_OFFSET);
+		if (!pid_tracking) {
+			prev_error = error;
+			pid_bumpless(terms, g, error, 0, (int32_t)pwm_applied * reversal_sign(), &integralVal);
+		}
+		else if (terms != terms_last || kpid[0] != k_last[0] || kpid[1] != k_last[1] ||
+				 kpid[2] != k_last[2] || gs_on != gs_last || rate != rate_last) {
+			int32_t integ_old = integralVal;
+			int64_t u_old = pid_law(terms_last)(&g_last, error, error - prev_error, &integ_old);
+			pid_bumpless(terms, g, error, error - prev_error, u_old, &integralVal);
+		}
+		terms_last = terms;
+		g_last = *g;
+		k_last[0] = kpid[0];
+		k_last[1] = kpid[1];
+		k_last[2] = kpid[2];
+		gs_last = gs_on;
+		rate_last = rate;
+
+		int64_t u = pid_law(terms)(g, error, error - prev_error, &integralVal);
+
+		pwm_calc = (u > 255) ? 255 : (u < -255) ? -255 : (int32_t)u;
+		pwm_saturated = (u > 255 || u < -255);
+
+		// Only ever drive in the applied direction, the sequencer handles reversals
+		pwm_calc *= reversal_sign();
+		if (pwm_calc < 0)
+			pwm_calc = 0;
+		else if (pwm_calc > 255)
+			pwm_calc = 255;
+		pwm_new = pwm_calc;
+
+		// Start the integrator afresh once a reversal has completed
+		if (reversal_state() != REV_DRIVE)
+			integralVal = 0;
+
+		// Map the rpm_new to pwm_new from 0  to 255
+		rpm_new = scale_pwm_to_rpm(pwm_new);
+
+		// Cap the pwm (200 unless changed from the console)
+		if (pwm_new > pwm_limit) {
+			pwm_new = pwm_limit;
+			pwm_saturated = true;
+		}
 
-		pwm_actual = (rpm_actual * 255) / 6000;
-		pwm_target = (stptRPM * 255) / 6000;
+		/* Let the fault manager check for stall, overspeed and sensor loss and
+		 * limit the output. Don't integrate while the drive is being stopped.
+		 */
+		pwm_new = fault_step(rpm_raw, fresh, looprate_last_dt_us(), pwm_new);
+		if (fault_state() >= FAULT_ST_RAMP_DOWN)
+			integralVal = 0;
+		sup_checkin(SUP_CH_CONTROL);
 
-		// display the captured rpm onto the 7 segment display -> Digit[7:4]
-		NX410_SSEG_setAllDigits(SSEGHI, (rpm_actual / 1000) % 10, (rpm_actual / 100) % 10,
-										(rpm_actual / 10) % 10, rpm_actual % 10, DP_NONE);
+		bool bridge_on = fault_bridge_enabled() && reversal_bridge_enabled();
+		pwm_applied = drive_bridge(bridge_on, pwm_new);
+		sup_checkin(SUP_CH_ACTUATE);
 
-		if(rpm_actual < 5000) {
+		// Tell the observer what the motor is driven with until the next tick
+		obs_input(reversal_sign() * pwm_applied);
+		pid_tracking = true;
 
-			// Calculate the error between the setpoint and rpm detected from digital encoder
-			error = pwm_target - pwm_actual;
+		record_tick(stpt_eff, rpm_signed, pwm_new);
 
-			integralVal += error;
+		if (copyData == 1) {
+			xil_printf("%u,%u,", rpm_actual, stptRPM);
+			xil_printf("%u\n\r", rpm_new);
+		}
+	}
 
-			// Calculate the rpm by selecting the type of controller
-			pwm_new = kp_Sel * kpid[0] * error + kd_Sel * kpid[1] * ((error - prev_error) / time_step) + ki_Sel * kpid[2] * integralVal * time_step;
+	/**
+	 * apply_loop_rate() - Applies loop_rate_sel to the control task
+	 *
+	 * @brief The supervisor deadlines follow the loop period.
+	 */
+	void apply_loop_rate(void)
+	{
+		looprate_select((mode == CHAR_MODE) ? LOOP_NUM_RATES - 1 : loop_rate_sel);
+		arm_supervisor();
+	}
 
-			// Map the rpm_new to pwm_new from 0  to 255
-			rpm_new = (pwm_new * 6000) / 255;
+	/**
+	 * select_console_sp() - Makes the console setpoint the active one
+	 */
+	void select_console_sp(void)
+	{
+		sp_src = SP_SRC_CONSOLE;
+	}
+
+	/**
+	 * cmd_stats() - Console "stats": scheduler statistics
+	 */
+	void cmd_stats(void)
+	{
+		sched_report();
+	}
 
-			// Cap the pwm till 200
-			pwm_new = fmin(pwm_new, 200);
+	/**
+	 * cmd_status() - Console "status": mode, fault state and loop rate
+	 */
+	void cmd_status(void)
+	{
+		xil_printf("mode=%d fault=%s code=%d rate=%dHz dt=%uus\r\n", mode,
+				   fault_state_str(fault_state()), fault_code(),
+				   looprate_hz(looprate_get()), looprate_last_dt_us());
+	}
 
-			PMODHB3_SetConfig(XPAR_PMODHB3_IP_0_S00_AXI_BASEADDR, PMODHB3_IP_S00_AXI_SLV_REG1_OFFSET,
-							   (1 << 9 | !direction << 8 | pwm_new));
+	/**
+	 * cmd_clear() - Console "clear": acknowledges a stopped or latched fault
+	 */
+	void cmd_clear(void)
+	{
+		if (fault_clear())
+			integralVal = 0;
+	}
 
-			if (copyData == 1) {
-				xil_printf("%u,%u,", rpm_actual, stptRPM);
-				xil_printf("%u\n\r", rpm_new);
-			}
+	/**
+	 * cmd_reset() - Console "reset": stops the motor and lets the watchdog reset the system
+	 */
+	void cmd_reset(void)
+	{
+		sup_request_reset(SUP_CAUSE_USER);
+	}
+
+	/**
+	 * apply_fr_trigger() - Applies the console trigger settings to the flight recorder
+	 */
+	void apply_fr_trigger(void)
+	{
+		fr_set_trigger(fr_trig_src, fr_trig_level);
+	}
+
+	/**
+	 * select_gs_point() - Loads the speed of the breakpoint selected from the console
+	 */
+	void select_gs_point(void)
+	{
+		gs_bp_rpm = gs_point_rpm(gs_bp_sel);
+	}
+
+	/**
+	 * apply_gs_rpm() - Moves the selected breakpoint, undoing the write if it would
+	 * 					break the ordering
+	 */
+	void apply_gs_rpm(void)
+	{
+		if (!gs_set_rpm(gs_bp_sel, gs_bp_rpm))
+			gs_bp_rpm = gs_point_rpm(gs_bp_sel);
+	}
+
+	/**
+	 * apply_obs_model() - Applies the console observer settings
+	 */
+	void apply_obs_model(void)
+	{
+		obs_set_model(obs_k_q8, (u32)obs_tau_ms * 1000);
+		obs_set_gain((u32)obs_l_q8 << 8);
+	}
+
+	/**
+	 * apply_disp_page() - Selects the display page written from the console
+	 */
+	void apply_disp_page(void)
+	{
+		disp_select(disp_page_sel);
+		disp_page_sel = disp_page();	// undo a page number past the end of the table
+	}
+
+	/**
+	 * apply_disp_cycle() - Applies the console page cycling interval
+	 */
+	void apply_disp_cycle(void)
+	{
+		disp_set_cycle((u32)disp_cycle_s * 1000000 / DISPLAY_TASK_PERIOD_US);
+	}
+
+	/**
+	 * disp_rpm() .. disp_fault() - Values shown on the display pages
+	 */
+	int32_t disp_rpm(void)
+	{
+		return rpm_meas;
+	}
+
+	int32_t disp_stpt(void)
+	{
+		return stptRPM;
+	}
+
+	int32_t disp_duty(void)
+	{
+		return status_snapshot()->pwm;
+	}
+
+	int32_t disp_error(void)
+	{
+		return error;
+	}
+
+	int32_t disp_integ(void)
+	{
+		return integralVal;
+	}
+
+	int32_t disp_period(void)
+	{
+		return looprate_last_dt_us();
+	}
+
+	int32_t disp_fault(void)
+	{
+		return fault_code();
+	}
+
+	int32_t disp_load(void)
+	{
+		return load_total();
+	}
+
+	/**
+	 * cmd_play() - Console "play": follows the streamed profile
+	 *
+	 * @brief Selects the stream as the setpoint source and arms playback, which
+	 * 		  starts once enough points are queued.
+	 */
+	void cmd_play(void)
+	{
+		sp_src = SP_SRC_STREAM;
+		prof_play();
+	}
+
+	/**
+	 * cmd_char() - Console "char": enters CHAR mode
+	 *
+	 * @brief Characterizes the motor open loop, about half a minute. The center button,
+	 * 		  the encoder switch or "set mode 0" abort it.
+	 */
+	void cmd_char(void)
+	{
+		if (mode != SET_MODE || fault_state() != FAULT_ST_RUNNING) {
+			xil_printf("char: SET mode only, with no fault\r\n");
+			return;
 		}
+
+		mchar_start();
+		mode = CHAR_MODE;
+		arm_supervisor();
+		apply_loop_rate();
+	}
+
+	/**
+	 * apply_char_result() - Uses the characterized motor from now on
+	 *
+	 * @brief The speed at full PWM becomes the RPM <-> PWM full scale, the setpoint
+	 * 		  limit keeps the same share of it as the defaults (5000 of 6000 RPM) and
+	 * 		  the observer gets the measured gain and time constant.
+	 */
+	void apply_char_result(void)
+	{
+		const mchar_result_t *r = mchar_result();
+		u32 lim = (u32)r->rpm_max * RPM_LIMIT_DEFAULT / SCALE_RPM_FULL;
+
+		scale_init(r->rpm_max);
+		rpm_limit = (lim > RPM_LIMIT_DEFAULT) ? RPM_LIMIT_DEFAULT : lim;
+
+		obs_k_q8 = (r->gain_q8 > UINT16_MAX) ? UINT16_MAX : r->gain_q8;
+		obs_tau_ms = (r->tau_us < 1000) ? 1 : (r->tau_us > 10000000) ? 10000 : r->tau_us / 1000;
+		apply_obs_model();
+	}
+
+	/**
+	 * cmd_diag() - Console "diag": enters DIAG mode
+	 *
+	 * @brief Runs the peripheral self-tests skipped at boot and measures the AXI latency.
+	 * 		  The tests overwrite the peripheral registers, so DIAG mode can only be
+	 * 		  entered from SET mode. SET mode redraws the display afterwards.
+	 */
+	void cmd_diag(void)
+	{
+		if (mode != SET_MODE) {
+			xil_printf("diag: SET mode only\r\n");
+			return;
+		}
+
+		diag_start();
+		pwm_applied = 0;
+		mode = DIAG_MODE;
+		arm_supervisor();
+	}
+
+	/**
+	 * cmd_pidbench() - Console "pidbench": times the control law variants
+	 *
+	 * @brief The benchmark runs for several milliseconds in one go, so it is refused
+	 * 		  while the control task drives the motor, the ramp-down included.
+	 */
+	void cmd_pidbench(void)
+	{
+		if (mode != SET_MODE || pwm_applied != 0) {
+			xil_printf("pidbench: SET mode only, with the motor stopped\r\n");
+			return;
+		}
+
+		pid_bench();
 	}
 
 	/**
@@ -483,34 +1379,37 @@
 	*
 	* This function is executed once at start-up and after resets.  It initializes
 	* the peripherals and registers the interrupt handler(s)
+	*
+	* The H-bridge is disabled first, so the motor is stopped within a few register
+	* writes of a reset whatever state the reset left it in. Every step is timed
+	* (see boottime.h). The destructive register self-tests no longer run here;
+	* DIAG mode runs them on demand.
 	*/
 	XStatus do_init(void)
 	{
 		uint32_t status;				// status from Xilinx Lib calls
 
-		// Configure the uart Module
-		uart.IsReady= true;
-		uart.RegBaseAddress = XPAR_UARTLITE_1_BASEADDR;
-		XUartLite_Config uart_cfg;
-		uart_cfg.BaudRate = 115200;
-		uart_cfg.DataBits= 8;
-		uart_cfg.RegBaseAddr = XPAR_UARTLITE_1_BASEADDR;
-		uart_cfg.UseParity = false;
-		uart_cfg.ParityOdd = true;
-
-		// Initialize the uart
-		XUartLite_CfgInitialize(&uart, &uart_cfg, XPAR_UARTLITE_1_BASEADDR);
-		XUartLite_Initialize(&uart, XPAR_UARTLITE_1_DEVICE_ID);
+		// Disable the H-bridge before anything else
+		status = PMODHB3_Initialize(&HB3_Inst, XPAR_PMODHB3_IP_0_S00_AXI_BASEADDR);
+		if (status != XST_SUCCESS)
+			return XST_FAILURE;
+		sup_safe_state();
 
-		// Initialize the PMODENC544 Encoder peripheral
-		status = PMODENC544_initialize(XPAR_PMODENC544_0_S00_AXI_BASEADDR);
+		// Start the free-running timebase used by the scheduler and the boot timing
+		status = timebase_init();
 		if (status != XST_SUCCESS)
 			return XST_FAILURE;
+		boot_mark("safe_state");
 
-		// Initialize the PMODHB3 peripheral
-		status = PMODHB3_Initialize(XPAR_PMODHB3_IP_0_S00_AXI_BASEADDR);
+		// Initialize the uart from the configuration in xparameters.h
+		XUartLite_Initialize(&uart, XPAR_UARTLITE_1_DEVICE_ID);
+		boot_mark("uart");
+
+		// Initialize the PMODENC544 Encoder peripheral
+		status = PMODENC544_initialize(&ENC_Inst, XPAR_PMODENC544_0_S00_AXI_BASEADDR);
 		if (status != XST_SUCCESS)
 			return XST_FAILURE;
+		boot_mark("encoder");
 
 		// initialize the Nexys4 driver and (some of)the devices
 		status = (uint32_t) NX4IO_initialize(N4IO_BASEADDR);
@@ -527,6 +1426,7 @@
 		// drivers up for the first time
 		NX4IO_SSEG_setSSEG_DATA(SSEGHI, 0x0058E30E);
 		NX4IO_SSEG_setSSEG_DATA(SSEGLO, 0x00144116);
+		status_init();
 
 		// Initialize the watchdog timer
 		status = XWdtTb_Initialize(&WDT_Inst, XPAR_AXI_TIMEBASE_WDT_0_DEVICE_ID);
@@ -535,9 +1435,22 @@
 		{
 			xil_printf("Failed to initialize watchdogtimer\r\n");
 		}
+		boot_mark("nx4io_wdt");
+
+		// Find out why we reset before the watchdog starts running again
+		sup_init(&WDT_Inst);
+		fault_init();
+		reversal_init();
+		gs_init();
+		obs_init();
+
+		// Keep a recording made before a watchdog or user reset so it can be dumped
+		fr_init(sup_reset_cause() != SUP_CAUSE_POWER_ON);
+		boot_mark("app_state");
 
 		// start
 		XWdtTb_Start(&WDT_Inst);
+		boot_mark("wdt_start");
 
 		return XST_SUCCESS;
 	}
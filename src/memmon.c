@@ -0,0 +1,191 @@
+/****************************************************************************************
+*   @file memmon.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Stack and heap usage monitor. See memmon.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "memmon.h"
+#include "scheduler.h"
+#include "sections.h"
+#include "xil_printf.h"
+
+/************************** Constant Definitions ***************************/
+// bytes below the current frame left unpainted when painting from inside main()
+#define MEMMON_PAINT_GUARD	64
+
+/***************************** Global variables ****************************/
+// Provided by lscript.ld. The stack grows down from _stack to _stack_end,
+// the heap grows up from _heap_start
+extern u32 _stack_end;
+extern u32 _stack;
+extern u32 _heap_start;
+extern u32 _heap_end;
+
+static u32 *stack_mark = &_stack;		// lowest stack word known to be overwritten
+static u8 deepest_task = SCHED_NO_TASK;	// task running when stack_mark last moved
+static u32 last_stack_used = 0;
+static u32 last_heap_used = 0;
+static u8 report_ticks = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Paints the unused part of the stack and the heap
+ *
+ * @note    Call first thing in main(), before anything can allocate. Everything
+ *          below the caller's frame (less a small guard for this function's own
+ *          frame) is painted
+ *
+ */
+void __attribute__((noinline)) memmon_init(void)
+{
+	u32 *p = &_stack_end;
+	u32 *top = (u32 *)((u8 *)__builtin_frame_address(0) - MEMMON_PAINT_GUARD);
+
+	while (p < top)
+		*p++ = MEMMON_PAINT;
+
+	for (p = &_heap_start; p < &_heap_end; p++)
+		*p = MEMMON_PAINT;
+
+	stack_mark = top;
+	deepest_task = SCHED_NO_TASK;
+}
+
+
+/**
+ * Returns the lowest stack word whose paint has been overwritten
+ *
+ * @param   limit   address to stop at, returned if nothing below it was touched
+ *
+ * @note    Scans up from the bottom of the stack, so a gap of words a frame
+ *          reserved but never wrote does not hide the words below it
+ *
+ */
+static HOT_CODE u32 *stack_lowest_used(u32 *limit)
+{
+	u32 *p = &_stack_end;
+
+	while (p < limit && *p == MEMMON_PAINT)
+		p++;
+
+	return p;
+}
+
+
+/**
+ * Checks whether the stack has grown past the known mark and, if so, charges
+ * the new depth to the task that just ran
+ *
+ * @param   task_id     scheduler index of the task that just ran
+ *
+ * @note    Reads the still-painted words below the mark, at most the free
+ *          part of the stack
+ *
+ */
+HOT_CODE void memmon_sample(u8 task_id)
+{
+	u32 *lowest = stack_lowest_used(stack_mark);
+
+	if (lowest == stack_mark)
+		return;
+
+	stack_mark = lowest;
+	deepest_task = task_id;
+}
+
+
+/**
+ * Returns the size of the stack reserved by the linker script
+ *
+ */
+u32 memmon_stack_size(void)
+{
+	return (u32)((u8 *)&_stack - (u8 *)&_stack_end);
+}
+
+
+/**
+ * Returns the deepest stack usage seen since boot
+ *
+ * @return  bytes of stack used at the deepest point
+ *
+ */
+u32 memmon_stack_high_water(void)
+{
+	return (u32)((u8 *)&_stack - (u8 *)stack_lowest_used(&_stack));
+}
+
+
+/**
+ * Returns the task that was running when the stack reached its deepest
+ * sampled point, SCHED_NO_TASK if it happened outside a task
+ *
+ */
+u8 memmon_deepest_task(void)
+{
+	return deepest_task;
+}
+
+
+/**
+ * Returns the size of the heap reserved by the linker script
+ *
+ */
+u32 memmon_heap_size(void)
+{
+	return (u32)((u8 *)&_heap_end - (u8 *)&_heap_start);
+}
+
+
+/**
+ * Returns the highest heap usage seen since boot
+ *
+ */
+u32 memmon_heap_high_water(void)
+{
+	u32 *p = &_heap_end;
+
+	while (p > &_heap_start && *(p - 1) == MEMMON_PAINT)
+		p--;
+
+	return (u32)((u8 *)p - (u8 *)&_heap_start);
+}
+
+
+/**
+ * Prints the stack and heap high-water marks over the UART
+ *
+ */
+void memmon_report(void)
+{
+	const sched_task_t *t = sched_get_task(deepest_task);
+
+	xil_printf("MEM,stack,%u,%u,%s,heap,%u,%u\r\n", memmon_stack_high_water(), memmon_stack_size(),
+			t ? t->name : "boot", memmon_heap_high_water(), memmon_heap_size());
+}
+
+
+/**
+ * Low priority task: rescans the painted regions and reports when a
+ * high-water mark moved, or every MEMMON_REPORT_TICKS calls otherwise
+ *
+ */
+void memmon_task(void)
+{
+	u32 stack_used = memmon_stack_high_water();
+	u32 heap_used = memmon_heap_high_water();
+	bool moved = (stack_used != last_stack_used) || (heap_used != last_heap_used);
+
+	last_stack_used = stack_used;
+	last_heap_used = heap_used;
+
+	if (moved || ++report_ticks >= MEMMON_REPORT_TICKS) {
+		report_ticks = 0;
+		memmon_report();
+	}
+}
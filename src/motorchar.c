@@ -0,0 +1,317 @@
+/****************************************************************************************
+*   @file motorchar.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Open-loop motor characterization. See motorchar.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "motorchar.h"
+#include "PMODHB3_IP.h"
+#include "fault.h"
+#include "xil_printf.h"
+
+/************************** Constant Definitions ***************************/
+#define MCHAR_WINDOW_US		PMODHB3_TACH_WINDOW_US
+
+// PWM levels of the staircase, the last one is full output
+static const u8 levels[MCHAR_NUM_STEPS] = { 32, 64, 96, 128, 160, 192, 224, 255 };
+
+_Static_assert(1 + MCHAR_NUM_STEPS * MCHAR_STEP_WINDOWS <= MCHAR_TRACE_LEN, "trace too short for the staircase");
+_Static_assert(MCHAR_SS_WINDOWS <= MCHAR_STEP_WINDOWS, "settling average longer than a level");
+
+/***************************** Global variables ****************************/
+static mchar_sample_t trace[MCHAR_TRACE_LEN];
+static u16 trace_len = 0;
+
+static u8 state = MCHAR_IDLE;
+static u8 level = 0;				// staircase level being applied
+static u8 windows = 0;				// tach windows seen in the current state or level
+static u8 stopped_cnt = 0;
+static const char *fail_reason = "";
+
+static mchar_result_t result = { 0, 0, 0, MCHAR_DEFAULT_START_PWM, false };
+
+static bool dumping = false;
+static u16 dump_idx = 0;
+static u16 dump_len = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Ends the run without touching the previous result
+ *
+ */
+static void mchar_fail(const char *reason)
+{
+	fail_reason = reason;
+	state = MCHAR_FAILED;
+}
+
+
+/**
+ * Stores one tach reading in the trace
+ *
+ */
+static void mchar_record(u32 now_us, u32 rpm, u8 pwm, u8 step)
+{
+	if (trace_len >= MCHAR_TRACE_LEN)
+		return;
+
+	mchar_sample_t *s = &trace[trace_len++];
+	s->t_us = now_us;
+	s->rpm = (rpm > 0xFFFF) ? 0xFFFF : rpm;
+	s->pwm = pwm;
+	s->step = step;
+}
+
+
+/**
+ * Fits gain, deadband, tau and rpm_max to the trace of a complete staircase.
+ * Runs from mchar_task(), so the divisions stay out of the control tick
+ *
+ */
+static void mchar_fit(void)
+{
+	int64_t sx = 0, sy = 0, sxx = 0, sxy = 0;		// least squares sums, PWM against speed
+	int64_t area = 0, delta = 0;					// tau sums
+	u8 n = 0;
+	int32_t w_start = trace[0].rpm;
+	int32_t ss = 0;
+
+	for (u8 l = 0; l < MCHAR_NUM_STEPS; l++) {
+		const mchar_sample_t *s = &trace[1 + l * MCHAR_STEP_WINDOWS];
+
+		ss = 0;
+		for (u8 k = MCHAR_STEP_WINDOWS - MCHAR_SS_WINDOWS; k < MCHAR_STEP_WINDOWS; k++)
+			ss += s[k].rpm;
+		ss /= MCHAR_SS_WINDOWS;
+
+		// levels inside the deadband would bend the line
+		if (ss >= MCHAR_MOVE_RPM) {
+			n++;
+			sx += levels[l];
+			sy += ss;
+			sxx += (int64_t)levels[l] * levels[l];
+			sxy += (int64_t)levels[l] * ss;
+		}
+
+		// area between the response and where it settled, one window at a time
+		if (ss - w_start >= MCHAR_MIN_DELTA_RPM) {
+			for (u8 k = 0; k < MCHAR_STEP_WINDOWS; k++)
+				area += (int64_t)(ss - s[k].rpm) * MCHAR_WINDOW_US;
+			delta += ss - w_start;
+		}
+
+		w_start = ss;
+	}
+
+	int64_t num = n * sxy - sx * sy;
+	int64_t den = n * sxx - sx * sx;
+
+	if (ss < MCHAR_MIN_FULL_RPM) {
+		mchar_fail("no rotation");
+		return;
+	}
+	if (n < 2 || num <= 0 || den <= 0) {
+		mchar_fail("no gain");
+		return;
+	}
+	if (delta == 0 || area <= 0) {
+		mchar_fail("no step response");
+		return;
+	}
+
+	// gain = num / den, and the line crosses zero speed at mean(pwm) - mean(rpm) / gain
+	int64_t db = (sx * num - sy * den) / (n * num);
+
+	result.gain_q8 = (u32)((num * 256 + den / 2) / den);
+	result.deadband = (db < 0) ? 0 : (db > 255) ? 255 : (u8)db;
+	result.tau_us = (u32)(area / delta);
+	result.rpm_max = (ss > 0xFFFF) ? 0xFFFF : (u16)ss;
+	result.valid = true;
+
+	state = MCHAR_DONE;
+}
+
+
+/**
+ * Starts a characterization. The previous result is kept until this one succeeds
+ *
+ */
+void mchar_start(void)
+{
+	state = MCHAR_STOP;
+	level = 0;
+	windows = 0;
+	stopped_cnt = 0;
+	trace_len = 0;
+	dumping = false;
+	fail_reason = "";
+}
+
+
+/**
+ * Stops a characterization in progress
+ *
+ */
+void mchar_abort(void)
+{
+	if (mchar_running())
+		mchar_fail("aborted");
+}
+
+
+/**
+ * Runs the characterization for one control tick
+ *
+ * @param   rpm     tach reading
+ * @param   fresh   true if the reading is new since the previous tick
+ * @param   now_us  timebase
+ *
+ * @return  PWM to apply, in the forward direction
+ *
+ */
+u8 mchar_step(u32 rpm, bool fresh, u32 now_us)
+{
+	switch (state) {
+		case MCHAR_STOP:
+			if (!fresh)
+				return 0;
+			if (++windows > MCHAR_STOP_TIMEOUT) {
+				mchar_fail("motor did not stop");
+				return 0;
+			}
+
+			stopped_cnt = (rpm < MCHAR_STOPPED_RPM) ? stopped_cnt + 1 : 0;
+			if (stopped_cnt < MCHAR_STOP_WINDOWS)
+				return 0;
+
+			// this reading is the baseline, the first level starts with the next window
+			mchar_record(now_us, rpm, 0, 0);
+			level = 0;
+			windows = 0;
+			state = MCHAR_STEP;
+			return levels[0];
+
+		case MCHAR_STEP:
+			if (fresh) {
+				if (rpm > FAULT_SENSOR_MAX_RPM) {
+					mchar_fail("tach reading invalid");
+					return 0;
+				}
+
+				mchar_record(now_us, rpm, levels[level], level + 1);
+
+				if (++windows >= MCHAR_STEP_WINDOWS) {
+					windows = 0;
+					if (++level >= MCHAR_NUM_STEPS) {
+						state = MCHAR_FIT;
+						return 0;
+					}
+				}
+			}
+			return levels[level];
+
+		default:
+			return 0;
+	}
+}
+
+
+/**
+ * Characterization task: fits a completed staircase and prints up to
+ * MCHAR_DUMP_LINES samples of a dump in progress
+ *
+ */
+void mchar_task(void)
+{
+	if (state == MCHAR_FIT)
+		mchar_fit();
+
+	if (!dumping)
+		return;
+
+	for (u8 n = 0; n < MCHAR_DUMP_LINES; n++) {
+		if (dump_idx >= dump_len) {
+			xil_printf("CHAR,end\r\n");
+			dumping = false;
+			return;
+		}
+
+		const mchar_sample_t *s = &trace[dump_idx];
+		xil_printf("CHAR,%d,%u,%d,%d\r\n", dump_idx, s->t_us, s->pwm, s->rpm);
+		dump_idx++;
+	}
+}
+
+
+/**
+ * Returns the state (MCHAR_*)
+ *
+ */
+u8 mchar_state(void)
+{
+	return state;
+}
+
+
+/**
+ * Returns true while the motor is driven or the fit is pending
+ *
+ */
+bool mchar_running(void)
+{
+	return state == MCHAR_STOP || state == MCHAR_STEP || state == MCHAR_FIT;
+}
+
+
+/**
+ * Returns the result of the last successful characterization
+ *
+ */
+const mchar_result_t *mchar_result(void)
+{
+	return &result;
+}
+
+
+/**
+ * Returns the duty cycle that gets the motor turning from rest
+ *
+ */
+u8 mchar_start_pwm(void)
+{
+	return result.valid ? result.deadband : MCHAR_DEFAULT_START_PWM;
+}
+
+
+/**
+ * Prints the state and the result:
+ *     CHAR,state,<state>,<reason if failed>
+ *     CHAR,fit,<gain_q8>,<deadband>,<tau_us>,<rpm_max>    once one has succeeded
+ *
+ */
+void mchar_report(void)
+{
+	xil_printf("CHAR,state,%d,%s\r\n", state, (state == MCHAR_FAILED) ? fail_reason : "");
+
+	if (result.valid)
+		xil_printf("CHAR,fit,%u,%d,%u,%d\r\n", result.gain_q8, result.deadband,
+				   result.tau_us, result.rpm_max);
+}
+
+
+/**
+ * Starts printing the trace from mchar_task()
+ *
+ */
+void mchar_dump_start(void)
+{
+	xil_printf("CHAR,trace,%d\r\n", trace_len);
+	dump_idx = 0;
+	dump_len = trace_len;
+	dumping = true;
+}
@@ -17,6 +17,7 @@
 * ----- ---- -------- -----------------------------------------------
 * 1.00a	rhk	12/20/14	First release of driver
 * 1.01a	rhk	01/10/18	updates for SDK 2017.3
+* 1.02a	sg	03/15/23	NX4IO_initialize() no longer runs the self-test
 * </pre>
 *
 ******************************************************************************/
@@ -45,7 +46,8 @@ void bin2hex(u32 bin, u8 *hex);
 /**
 * Initialize the NEXYS4IO peripheral driver
 *
-* Saves the Base address of the NEXYS4IO peripheral and runs the selftest
+* Saves the Base address of the NEXYS4IO peripheral.  The selftest overwrites
+* the LEDs and the display, call NEXYS4IO_Reg_SelfTest() separately for diagnostics
 *
 * @param	BaseAddr is the base address of the NEXYS4IO register set
 *
@@ -59,7 +61,7 @@ void bin2hex(u32 bin, u8 *hex);
 int NX4IO_initialize(u32 BaseAddr)
 {
 	NX4IO_BaseAddress = BaseAddr;
-	return NEXYS4IO_Reg_SelfTest(NX4IO_BaseAddress);
+	return XST_SUCCESS;
 }
 
 
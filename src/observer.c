@@ -0,0 +1,162 @@
+/****************************************************************************************
+*   @file observer.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Luenberger speed observer. See observer.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "observer.h"
+#include "sections.h"
+
+/************************** Constant Definitions ***************************/
+#define OBS_ONE_Q16		65536
+
+/***************************** Global variables ****************************/
+static u32 model_k_q8 = OBS_DEFAULT_K_Q8;
+static u32 model_tau_us = OBS_DEFAULT_TAU_US;
+static u32 gain_l_q16 = OBS_DEFAULT_L_Q16;
+
+static int32_t est_q8 = 0;			// speed estimate, Q8 RPM
+static int32_t bias_q8 = 0;			// steady-state speed error of the model (load, gain error), Q8 RPM
+static int32_t input = 0;			// signed PWM applied for the coming tick
+static bool valid = false;			// estimate has been seeded by a tach reading
+
+static u32 step_dt_us = 0;			// dt the model step was computed for
+static u32 step_q16 = 0;			// dt / tau, Q16
+
+static int64_t win_sum = 0;			// integral of the estimate over the tach window
+static u32 win_us = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Resets the observer to the default model
+ *
+ */
+void obs_init(void)
+{
+	model_k_q8 = OBS_DEFAULT_K_Q8;
+	model_tau_us = OBS_DEFAULT_TAU_US;
+	gain_l_q16 = OBS_DEFAULT_L_Q16;
+	step_dt_us = 0;
+	input = 0;
+	valid = false;
+	obs_reset(0);
+}
+
+
+/**
+ * Sets the motor model
+ *
+ * @param   k_q8    steady-state RPM per PWM count, Q8
+ * @param   tau_us  mechanical time constant
+ *
+ */
+void obs_set_model(u32 k_q8, u32 tau_us)
+{
+	model_k_q8 = k_q8;
+	model_tau_us = (tau_us > 0) ? tau_us : 1;
+	step_dt_us = 0;
+}
+
+
+/**
+ * Sets the observer gain, Q16. 0 runs the model open loop, 1.0 snaps to the tach
+ *
+ */
+void obs_set_gain(u32 l_q16)
+{
+	gain_l_q16 = (l_q16 > OBS_ONE_Q16) ? OBS_ONE_Q16 : l_q16;
+}
+
+
+/**
+ * Forces the estimate, e.g. when the drive is restarted
+ *
+ */
+void obs_reset(int32_t rpm)
+{
+	est_q8 = rpm * 256;
+	bias_q8 = 0;
+	win_sum = 0;
+	win_us = 0;
+}
+
+
+/**
+ * Runs the observer for one control tick
+ *
+ * @param   dt_us       time since the previous tick
+ * @param   rpm_meas    signed tach reading
+ * @param   fresh       true if the tach reading is new since the previous tick
+ *
+ * @return  the signed speed estimate in RPM
+ *
+ */
+HOT_CODE int32_t obs_step(u32 dt_us, int32_t rpm_meas, bool fresh)
+{
+	// nothing to predict from until the first reading, or after the loop was paused
+	if (!valid || dt_us > OBS_RESEED_US) {
+		valid = false;
+		if (fresh) {
+			obs_reset(rpm_meas);
+			valid = true;
+		}
+		return rpm_meas;
+	}
+
+	/* dt / tau, clamped to one step so a long gap settles on the steady state.
+	 * Like the loop gains it is only recomputed when the measured period moves
+	 * more than 1/8 away from the one it was computed for, not on every jitter
+	 */
+	u32 tol = step_dt_us >> 3;
+	if (dt_us > step_dt_us + tol || dt_us + tol < step_dt_us) {
+		uint64_t q = ((uint64_t)dt_us << 16) / model_tau_us;
+		step_q16 = (q > OBS_ONE_Q16) ? OBS_ONE_Q16 : (u32)q;
+		step_dt_us = dt_us;
+	}
+
+	// predict with the PWM applied over the last tick
+	int32_t ss_q8 = (int32_t)model_k_q8 * input + bias_q8;
+	est_q8 += (int32_t)(((int64_t)step_q16 * (ss_q8 - est_q8)) >> 16);
+
+	win_sum += (int64_t)est_q8 * dt_us;
+	win_us += dt_us;
+
+	// correct against the estimate averaged over the tach window
+	if (fresh && win_us > 0) {
+		int32_t avg_q8 = (int32_t)(win_sum / win_us);
+		int32_t innov_q8 = rpm_meas * 256 - avg_q8;
+
+		est_q8 += (int32_t)(((int64_t)gain_l_q16 * innov_q8) >> 16);
+		bias_q8 += (int32_t)(((int64_t)OBS_BIAS_L_Q16 * innov_q8) >> 16);
+
+		win_sum = 0;
+		win_us = 0;
+	}
+
+	return est_q8 >> 8;
+}
+
+
+/**
+ * Records the signed PWM applied to the motor for the coming tick
+ *
+ */
+HOT_CODE void obs_input(int32_t pwm)
+{
+	input = pwm;
+}
+
+
+/**
+ * Returns the last speed estimate in RPM
+ *
+ */
+int32_t obs_estimate(void)
+{
+	return est_q8 >> 8;
+}
@@ -0,0 +1,178 @@
+/****************************************************************************************
+*   @file pidcore.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note P/I/D control law variants. See pidcore.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "pidcore.h"
+#include "sections.h"
+#include "timebase.h"
+#include "xil_printf.h"
+
+/************************** Function Definitions ***************************/
+/**
+ * Returns integ + e, held at the int32 limits instead of wrapping
+ *
+ */
+static inline int32_t pid_sat_add(int32_t integ, int32_t e)
+{
+	int64_t s = (int64_t)integ + e;
+
+	return (s > INT32_MAX) ? INT32_MAX : (s < INT32_MIN) ? INT32_MIN : (int32_t)s;
+}
+
+
+/*
+ * Defines one control law. P, I and D are 0 or 1 and every test on them is
+ * resolved at compile time
+ */
+#define PID_DEFINE_LAW(name, P, I, D)											\
+	static HOT_CODE int64_t name(const loop_gains_t *g, int32_t e, int32_t de,	\
+								 int32_t *integ)								\
+	{																			\
+		int64_t u = 0;															\
+																				\
+		(void)g; (void)e; (void)de;												\
+		if (P)																	\
+			u += (int64_t)g->kp * e;											\
+		if (D)																	\
+			u += (int64_t)g->kd_over_dt * de;									\
+		if (I) {																\
+			int32_t prev = *integ;												\
+			*integ = pid_sat_add(prev, e);										\
+			int64_t ui = ((int64_t)g->ki_dt_q16 * *integ) >> 16;				\
+			if (PID_ANTI_WINDUP == PID_AW_CLAMP &&								\
+				((u + ui > PID_OUT_MAX && e > 0) ||							\
+				 (u + ui < -PID_OUT_MAX && e < 0))) {							\
+				*integ = prev;													\
+				ui = ((int64_t)g->ki_dt_q16 * *integ) >> 16;					\
+			}																	\
+			u += ui;															\
+		}																		\
+		else {																	\
+			*integ = 0;															\
+		}																		\
+		return u;																\
+	}
+
+PID_DEFINE_LAW(pid_law_off,	0, 0, 0)
+PID_DEFINE_LAW(pid_law_d,	0, 0, 1)
+PID_DEFINE_LAW(pid_law_i,	0, 1, 0)
+PID_DEFINE_LAW(pid_law_id,	0, 1, 1)
+PID_DEFINE_LAW(pid_law_p,	1, 0, 0)
+PID_DEFINE_LAW(pid_law_pd,	1, 0, 1)
+PID_DEFINE_LAW(pid_law_pi,	1, 1, 0)
+PID_DEFINE_LAW(pid_law_pid,	1, 1, 1)
+
+// Indexed by the term bits
+static const pid_law_t laws[PID_NUM_LAWS] = {
+	pid_law_off, pid_law_d, pid_law_i, pid_law_id,
+	pid_law_p, pid_law_pd, pid_law_pi, pid_law_pid
+};
+
+static const char *const law_names[PID_NUM_LAWS] = {
+	"off", "d", "i", "id", "p", "pd", "pi", "pid"
+};
+
+
+/**
+ * Returns the control law for a set of terms
+ *
+ * @param   terms   PID_TERM_* bits, same layout as sw[2:0]
+ *
+ */
+HOT_CODE pid_law_t pid_law(u8 terms)
+{
+	return laws[terms & (PID_NUM_LAWS - 1)];
+}
+
+
+/**
+ * Sets the integrator so that the law for a set of terms returns u this tick
+ *
+ * @param   terms   PID_TERM_* bits of the law about to run
+ * @param   g       gains it will run with
+ * @param   e       error it will be called with
+ * @param   de      error change it will be called with
+ * @param   u       output to continue from, clipped to PID_OUT_MAX first
+ * @param   integ   integrator, left alone if the law has no I term or ki is 0
+ *
+ * @note    Divides, so only call it on a transfer, not every tick
+ *
+ */
+void pid_bumpless(u8 terms, const loop_gains_t *g, int32_t e, int32_t de, int64_t u, int32_t *integ)
+{
+	if (!(terms & PID_TERM_I) || g->ki_dt_q16 <= 0)
+		return;
+
+	if (u > PID_OUT_MAX)
+		u = PID_OUT_MAX;
+	else if (u < -PID_OUT_MAX)
+		u = -PID_OUT_MAX;
+
+	// what the I term has to supply
+	if (terms & PID_TERM_P)
+		u -= (int64_t)g->kp * e;
+	if (terms & PID_TERM_D)
+		u -= (int64_t)g->kd_over_dt * de;
+
+	// smallest integrator with (ki * integ) >> 16 == u, less the e the law adds first
+	int64_t n = u * 65536;
+	int64_t i = n / g->ki_dt_q16;
+	if (i * g->ki_dt_q16 < n)
+		i++;
+	i -= e;
+
+	*integ = (i > INT32_MAX) ? INT32_MAX : (i < INT32_MIN) ? INT32_MIN : (int32_t)i;
+}
+
+
+/**
+ * Returns the name of the control law for a set of terms
+ *
+ */
+const char *pid_law_name(u8 terms)
+{
+	return law_names[terms & (PID_NUM_LAWS - 1)];
+}
+
+
+/**
+ * Times every control law over PID_BENCH_ITERS calls and prints one
+ * PID,<law>,<ticks> line each
+ *
+ * @note    Runs with fixed gains and a synthetic error so the variants can be
+ *          compared; the controller state is not touched
+ *
+ */
+void pid_bench(void)
+{
+	const loop_gains_t g = { .kp = 3, .ki_dt_q16 = 6554, .kd_over_dt = 2, .dt_us = 10000 };
+	volatile int64_t sink = 0;
+
+	xil_printf("PID,begin,%u,%u\r\n", timebase_ticks_per_us(), PID_BENCH_ITERS);
+
+	for (u8 i = 0; i < PID_NUM_LAWS; i++) {
+		pid_law_t law = laws[i];
+		int32_t integ = 0;
+		int32_t prev = 0;
+
+		u32 t0 = timebase_now_ticks();
+		for (u16 n = 0; n < PID_BENCH_ITERS; n++) {
+			int32_t e = (int32_t)(n & 0x3F) - 32;
+			sink = law(&g, e, e - prev, &integ);
+			prev = e;
+		}
+		u32 t1 = timebase_now_ticks();
+
+		xil_printf("PID,%s,%u\r\n", law_names[i], t1 - t0);
+	}
+
+	(void)sink;
+	xil_printf("PID,end\r\n");
+}
@@ -0,0 +1,241 @@
+/****************************************************************************************
+*   @file profile.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Streamed setpoint profile. See profile.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "profile.h"
+#include "console.h"
+#include "timebase.h"
+#include "sections.h"
+#include "xil_printf.h"
+
+/**************************** Type Definitions *****************************/
+typedef struct {
+	u16 dt_ms;
+	int16_t rpm;
+} prof_point_t;
+
+/***************************** Global variables ****************************/
+static prof_point_t ring[PROF_DEPTH];
+static u8 head = 0;					// next point to play
+static u8 count = 0;
+static bool end_queued = false;		// the end marker is in the ring
+
+static u8 state = PROF_IDLE;
+static u32 seg_start_us = 0;		// when the current segment began
+static u32 seg_len_us = 0;
+static int32_t seg_from = 0;		// setpoint at the start of the segment
+static int32_t seg_to = 0;
+static int64_t seg_slope_q32 = 0;	// RPM per microsecond, Q32
+static int32_t out = 0;				// last setpoint handed out
+static u32 underruns = 0;
+
+static const char *const state_names[] = { "idle", "armed", "playing", "starved", "done" };
+
+/************************** Function Definitions ***************************/
+/**
+ * Empties the ring and stops playback at 0 RPM
+ *
+ */
+void prof_init(void)
+{
+	prof_clear();
+	state = PROF_IDLE;
+	out = 0;
+	underruns = 0;
+}
+
+
+/**
+ * Queues one point
+ *
+ * @param   dt_ms   milliseconds from the previous point, PROF_END_DT for the end marker
+ * @param   rpm     signed setpoint at the point
+ *
+ * @return  false if the ring is full
+ *
+ */
+bool prof_push(u16 dt_ms, int16_t rpm)
+{
+	if (count == PROF_DEPTH)
+		return false;
+
+	ring[(head + count) & (PROF_DEPTH - 1)] = (prof_point_t) { dt_ms, rpm };
+	count++;
+
+	if (dt_ms == PROF_END_DT)
+		end_queued = true;
+
+	return true;
+}
+
+
+/**
+ * Returns the number of free slots in the ring
+ *
+ */
+u8 prof_free(void)
+{
+	return PROF_DEPTH - count;
+}
+
+
+/**
+ * Arms playback. It starts from the current setpoint once enough points are queued
+ *
+ */
+void prof_play(void)
+{
+	state = PROF_ARMED;
+}
+
+
+/**
+ * Stops playback, holding the current setpoint. Queued points are kept
+ *
+ */
+void prof_stop(void)
+{
+	state = PROF_IDLE;
+}
+
+
+/**
+ * Drops every queued point
+ *
+ */
+void prof_clear(void)
+{
+	head = 0;
+	count = 0;
+	end_queued = false;
+}
+
+
+/**
+ * Takes the next point off the ring and makes it the end of the segment
+ * starting at seg_start_us
+ *
+ * @return  false if there is no point to take or the end marker was taken
+ *
+ */
+static bool next_segment(void)
+{
+	if (count == 0)
+		return false;
+
+	prof_point_t p = ring[head];
+	head = (head + 1) & (PROF_DEPTH - 1);
+	count--;
+
+	if (p.dt_ms == PROF_END_DT) {
+		end_queued = false;
+		state = PROF_DONE;
+		return false;
+	}
+
+	seg_from = seg_to;
+	seg_to = p.rpm;
+	seg_len_us = (u32)p.dt_ms * TIMEBASE_US_PER_MS;
+	// Q32 keeps a 1 RPM step over the longest segment (65 s) from rounding to a flat line
+	seg_slope_q32 = seg_len_us ? ((int64_t)(seg_to - seg_from) << 32) / seg_len_us : 0;
+
+	return true;
+}
+
+
+/**
+ * Returns the setpoint for this control tick
+ *
+ * @param   limit   largest setpoint magnitude
+ *
+ * @return  signed setpoint, clamped to +-limit
+ *
+ */
+HOT_CODE int32_t prof_setpoint(u16 limit)
+{
+	u32 now = timebase_now_us();
+
+	// start, or carry on after an underrun, from the setpoint held now
+	if ((state == PROF_ARMED && (count >= PROF_START_POINTS || end_queued)) ||
+		(state == PROF_STARVED && count > 0)) {
+		seg_to = out;
+		seg_start_us = now;
+		seg_len_us = 0;
+		state = PROF_PLAYING;
+	}
+
+	if (state == PROF_PLAYING) {
+		// move on past every segment that has ended
+		while (state == PROF_PLAYING && now - seg_start_us >= seg_len_us) {
+			seg_start_us += seg_len_us;
+			if (!next_segment() && state == PROF_PLAYING) {
+				state = PROF_STARVED;
+				underruns++;
+			}
+		}
+
+		if (state == PROF_PLAYING)
+			out = seg_from + (int32_t)((seg_slope_q32 * (int64_t)(now - seg_start_us)) >> 32);
+		else
+			out = seg_to;
+	}
+
+	if (out > limit)
+		out = limit;
+	else if (out < -(int32_t)limit)
+		out = -(int32_t)limit;
+
+	return out;
+}
+
+
+/**
+ * Returns the last setpoint handed out by prof_setpoint()
+ *
+ */
+int32_t prof_current(void)
+{
+	return out;
+}
+
+
+/**
+ * Returns the playback state (PROF_*)
+ *
+ */
+u8 prof_state(void)
+{
+	return state;
+}
+
+
+/**
+ * Prints PROF,<state>,<queued>,<free>,<underruns>,<setpoint> over the UART
+ *
+ */
+void prof_report(void)
+{
+	xil_printf("PROF,%s,%u,%u,%u,%d\r\n", state_names[state], count, prof_free(), underruns, out);
+}
+
+
+/**
+ * Console stream handler: queues the point and answers with the free slots
+ *
+ */
+u8 prof_stream(u8 seq, u32 value, int32_t *reply)
+{
+	(void)seq;
+
+	bool ok = prof_push((u16)(value >> 16), (int16_t)(value & 0xFFFF));
+	*reply = prof_free();
+
+	return ok ? CONSOLE_BIN_OK : CONSOLE_BIN_ERR_FULL;
+}
@@ -0,0 +1,130 @@
+/****************************************************************************************
+*   @file reversal.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Direction reversal sequencer. See reversal.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "reversal.h"
+#include "sections.h"
+
+/***************************** Global variables ****************************/
+static u8 state = REV_DRIVE;
+static bool forward = true;		// direction currently applied to the bridge
+static u32 dwell_us = 0;			// time spent in DWELL so far
+
+/************************** Function Definitions ***************************/
+/**
+ * Resets the sequencer: driving forward, no reversal in progress
+ *
+ */
+void reversal_init(void)
+{
+	state = REV_DRIVE;
+	forward = true;
+	dwell_us = 0;
+}
+
+
+/**
+ * Runs the sequencer for one control tick
+ *
+ * @param   stpt_rpm    signed setpoint requested by the operator
+ * @param   rpm_meas    unsigned speed from the tach
+ * @param   dt_us       measured period of this tick
+ *
+ * @return  the signed setpoint the controller should track this tick
+ *
+ */
+HOT_CODE int32_t reversal_step(int32_t stpt_rpm, u32 rpm_meas, u32 dt_us)
+{
+	// a zero setpoint has no direction, so it never starts a reversal
+	bool want_reverse = (forward && stpt_rpm < 0) || (!forward && stpt_rpm > 0);
+
+	switch (state) {
+		case REV_DRIVE:
+			if (!want_reverse)
+				return stpt_rpm;
+			state = REV_DECEL;
+			// fall through
+
+		case REV_DECEL:
+			if (!want_reverse) {
+				// operator changed their mind before we got to zero
+				state = REV_DRIVE;
+				return stpt_rpm;
+			}
+			if (rpm_meas >= REV_THRESHOLD_RPM)
+				return 0;
+			state = REV_DWELL;
+			dwell_us = 0;
+			return 0;
+
+		case REV_DWELL:
+			dwell_us += dt_us;
+			if (dwell_us < REV_DWELL_US)
+				return 0;
+			if (want_reverse)
+				forward = !forward;
+			state = REV_DRIVE;
+			return stpt_rpm;
+
+		default:
+			state = REV_DRIVE;
+			return stpt_rpm;
+	}
+}
+
+
+/**
+ * Returns the tach reading signed with the direction applied to the bridge
+ *
+ */
+int32_t reversal_signed_rpm(u32 rpm_meas)
+{
+	return forward ? (int32_t)rpm_meas : -(int32_t)rpm_meas;
+}
+
+
+/**
+ * Returns +1 when driving forward, -1 when driving in reverse
+ *
+ */
+int32_t reversal_sign(void)
+{
+	return forward ? 1 : -1;
+}
+
+
+/**
+ * Returns the sequencer state (REV_*)
+ *
+ */
+u8 reversal_state(void)
+{
+	return state;
+}
+
+
+/**
+ * Returns the value for the direction bit in the PMODHB3 config register
+ *
+ */
+u8 reversal_dir_bit(void)
+{
+	return forward ? 0 : 1;
+}
+
+
+/**
+ * Returns false while coasting through a reversal
+ *
+ */
+bool reversal_bridge_enabled(void)
+{
+	return !(state == REV_DWELL && REV_DWELL_MODE == REV_DWELL_COAST);
+}
@@ -0,0 +1,203 @@
+/****************************************************************************************
+*   @file scale.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Integer RPM <-> PWM scaling. See scale.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "scale.h"
+#include "sections.h"
+
+/**************************** Type Definitions *****************************/
+// Progress of the self-test through one ratio
+typedef struct {
+	const scale_ratio_t *r;
+	u32 d;
+	u32 x_max;
+	u32 whole;				// n / d, added to the reference for each x
+	u32 rem_step;			// n % d
+	u32 x;					// next input to check
+	u32 q;					// reference x * n / d
+	u32 rem;				// reference remainder
+} scale_check_t;
+
+/***************************** Global variables ****************************/
+static u32 rpm_full = SCALE_RPM_FULL;
+static scale_ratio_t rpm_to_pwm = SCALE_RATIO(SCALE_PWM_FULL, SCALE_RPM_FULL);
+static scale_ratio_t pwm_to_rpm = SCALE_RATIO(SCALE_RPM_FULL, SCALE_PWM_FULL);
+
+static scale_check_t checks[2];
+static u8 check_idx = 0;			// ratio the self-test is on
+static u32 check_bad = 0;			// mismatches so far
+
+/************************** Function Definitions ***************************/
+/**
+ * Applies a ratio to a magnitude
+ *
+ */
+static inline u32 scale_apply(const scale_ratio_t *r, u32 x)
+{
+	return x * r->whole + (u32)(((u64)x * r->frac) >> 32);
+}
+
+
+/**
+ * Applies a ratio to a signed value, truncating toward zero
+ *
+ */
+static inline int32_t scale_apply_signed(const scale_ratio_t *r, int32_t x)
+{
+	return (x < 0) ? -(int32_t)scale_apply(r, -(u32)x) : (int32_t)scale_apply(r, x);
+}
+
+
+/**
+ * Builds the ratio n / d. Only called when the full scale changes
+ *
+ */
+static void scale_make(scale_ratio_t *r, u32 n, u32 d)
+{
+	r->whole = SCALE_WHOLE(n, d);
+	r->frac = SCALE_FRAC(n, d);
+}
+
+
+/**
+ * Sets the speed reached at full output
+ *
+ * @param   full    RPM at SCALE_PWM_FULL, 1 to SCALE_RPM_IN_MAX
+ *
+ * @return  XST_SUCCESS, or XST_FAILURE and the scaling unchanged if out of range
+ *
+ */
+XStatus scale_init(u32 full)
+{
+	if (full == 0 || full > SCALE_RPM_IN_MAX)
+		return XST_FAILURE;
+
+	scale_make(&rpm_to_pwm, SCALE_PWM_FULL, full);
+	scale_make(&pwm_to_rpm, full, SCALE_PWM_FULL);
+	rpm_full = full;
+
+	return XST_SUCCESS;
+}
+
+
+/**
+ * Returns the speed reached at full output
+ *
+ */
+u32 scale_rpm_full(void)
+{
+	return rpm_full;
+}
+
+
+/**
+ * Converts a signed speed to PWM counts: rpm * SCALE_PWM_FULL / full scale
+ *
+ */
+HOT_CODE int32_t scale_rpm_to_pwm(int32_t rpm)
+{
+	return scale_apply_signed(&rpm_to_pwm, rpm);
+}
+
+
+/**
+ * Converts signed PWM counts (or an encoder count) to a speed:
+ * pwm * full scale / SCALE_PWM_FULL
+ *
+ */
+HOT_CODE int32_t scale_pwm_to_rpm(int32_t pwm)
+{
+	return scale_apply_signed(&pwm_to_rpm, pwm);
+}
+
+
+/**
+ * Sets up the check of one ratio against x * n / d for x = -x_max..x_max
+ *
+ */
+static void scale_check_init(scale_check_t *c, const scale_ratio_t *r, u32 n, u32 d, u32 x_max)
+{
+	c->r = r;
+	c->d = d;
+	c->x_max = x_max;
+	c->whole = n / d;
+	c->rem_step = n % d;
+	c->x = 0;
+	c->q = 0;
+	c->rem = 0;
+}
+
+
+/**
+ * Checks up to count more inputs of one ratio. The reference quotient and
+ * remainder are stepped by n for each x, so no divide is needed
+ *
+ * @return  number of mismatches
+ *
+ */
+static u32 scale_check(scale_check_t *c, u32 count)
+{
+	u32 bad = 0;
+
+	for (; count > 0 && c->x <= c->x_max; count--, c->x++) {
+		if (scale_apply_signed(c->r, c->x) != (int32_t)c->q ||
+			scale_apply_signed(c->r, -(int32_t)c->x) != -(int32_t)c->q)
+			bad++;
+
+		c->q += c->whole;
+		c->rem += c->rem_step;
+		if (c->rem >= c->d) {
+			c->rem -= c->d;
+			c->q++;
+		}
+	}
+
+	return bad;
+}
+
+
+/**
+ * Starts a self-test of both conversions for the current full scale
+ *
+ */
+void scale_selftest_start(void)
+{
+	scale_check_init(&checks[0], &rpm_to_pwm, SCALE_PWM_FULL, rpm_full, SCALE_RPM_IN_MAX);
+	scale_check_init(&checks[1], &pwm_to_rpm, rpm_full, SCALE_PWM_FULL, SCALE_PWM_IN_MAX);
+	check_idx = 0;
+	check_bad = 0;
+}
+
+
+/**
+ * Checks the next SCALE_TEST_SLICE inputs of the self-test
+ *
+ * @param   result  set once the whole input range is done: XST_SUCCESS if every
+ *                  result equals the truncating division
+ *
+ * @return  true once the whole input range has been checked
+ *
+ */
+bool scale_selftest_step(XStatus *result)
+{
+	if (check_idx < 2) {
+		scale_check_t *c = &checks[check_idx];
+
+		check_bad += scale_check(c, SCALE_TEST_SLICE);
+		if (c->x > c->x_max)
+			check_idx++;
+	}
+
+	if (check_idx < 2)
+		return false;
+
+	*result = (check_bad == 0) ? XST_SUCCESS : XST_FAILURE;
+	return true;
+}
@@ -0,0 +1,249 @@
+/****************************************************************************************
+*   @file scheduler.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Cooperative static-table scheduler. See scheduler.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "scheduler.h"
+#include "timebase.h"
+#include "xil_printf.h"
+#include "sections.h"
+
+/***************************** Global variables ****************************/
+static sched_task_t *tasks = NULL;
+static u8 num_tasks = 0;
+static u8 current_task = SCHED_NO_TASK;
+static sched_hook_t post_hook = NULL;
+static volatile bool kicked[SCHED_MAX_TASKS];	// set from interrupt handlers
+
+/************************** Function Definitions ***************************/
+/**
+ * Registers the static task table and computes the first release of every task
+ *
+ * @param   table   application task table
+ * @param   ntasks  number of entries in the table (at most SCHED_MAX_TASKS)
+ *
+ */
+void sched_init(sched_task_t *table, u8 ntasks)
+{
+	u32 now = timebase_now_us();
+
+	tasks = table;
+	num_tasks = (ntasks > SCHED_MAX_TASKS) ? SCHED_MAX_TASKS : ntasks;
+	current_task = SCHED_NO_TASK;
+
+	for (u8 i = 0; i < num_tasks; i++) {
+		tasks[i].next_release_us = now + tasks[i].offset_us;
+		kicked[i] = false;
+	}
+
+	sched_reset_stats();
+}
+
+
+/**
+ * Runs at most one task: the highest priority task that has been released
+ *
+ * @return  true if a task was dispatched, false if nothing was due (idle)
+ *
+ * @note    Ties in priority go to the task that appears first in the table
+ *
+ */
+HOT_CODE bool sched_dispatch(void)
+{
+	u32 now = timebase_now_us();
+	u8 sel = SCHED_NO_TASK;
+
+	// pick the highest priority released or kicked task
+	for (u8 i = 0; i < num_tasks; i++) {
+		if ((int32_t)(now - tasks[i].next_release_us) < 0 && !kicked[i])
+			continue;
+
+		if (sel == SCHED_NO_TASK || tasks[i].priority < tasks[sel].priority)
+			sel = i;
+	}
+
+	if (sel == SCHED_NO_TASK)
+		return false;
+
+	sched_task_t *t = &tasks[sel];
+	sched_stats_t *st = &t->stats;
+
+	kicked[sel] = false;
+
+	if ((int32_t)(now - t->next_release_us) >= 0) {
+		// release-to-start latency
+		u32 jitter = now - t->next_release_us;
+		st->last_jitter_us = jitter;
+		if (jitter > st->max_jitter_us)
+			st->max_jitter_us = jitter;
+
+		// schedule the next release on the original grid. Any release that has
+		// already passed is counted as a miss rather than run back-to-back
+		t->next_release_us += t->period_us;
+		while ((int32_t)(now - t->next_release_us) >= 0) {
+			t->next_release_us += t->period_us;
+			st->misses++;
+		}
+	}
+
+	u32 t0 = timebase_now_ticks();
+	current_task = sel;
+	t->fn();
+	current_task = SCHED_NO_TASK;
+
+	u32 exec = timebase_now_us() - now;
+
+	if (post_hook)
+		post_hook(sel);
+	st->busy_ticks += timebase_now_ticks() - t0;
+	st->runs++;
+	st->last_exec_us = exec;
+	if (exec > st->max_exec_us)
+		st->max_exec_us = exec;
+	if (exec > t->budget_us)
+		st->overruns++;
+
+	return true;
+}
+
+
+/**
+ * Returns the earliest release time of any task
+ *
+ * @note    Used by the idle loop to decide how long it may sleep
+ *
+ */
+u32 sched_next_release_us(void)
+{
+	u32 now = timebase_now_us();
+	u32 next = now + TIMEBASE_US_PER_SEC;
+
+	for (u8 i = 0; i < num_tasks; i++) {
+		if ((int32_t)(tasks[i].next_release_us - next) < 0)
+			next = tasks[i].next_release_us;
+	}
+
+	return next;
+}
+
+
+/**
+ * Makes a task run at the next dispatch, ahead of its release
+ *
+ * @param   id  task index
+ *
+ * @note    Safe to call from an interrupt handler
+ *
+ */
+void sched_kick(u8 id)
+{
+	if (id < num_tasks)
+		kicked[id] = true;
+}
+
+
+/**
+ * Installs a function called with the task index after every dispatch
+ *
+ * @param   hook    function to call, NULL to remove
+ *
+ */
+void sched_set_post_hook(sched_hook_t hook)
+{
+	post_hook = hook;
+}
+
+
+/**
+ * Changes the period of a task at runtime
+ *
+ * @param   id          task index
+ * @param   period_us   new period in microseconds
+ *
+ * @note    The next release moves to one new period from now so that a
+ *          change to a shorter period takes effect immediately
+ *
+ */
+void sched_set_period(u8 id, u32 period_us)
+{
+	if (id >= num_tasks || period_us == 0)
+		return;
+
+	tasks[id].period_us = period_us;
+	tasks[id].next_release_us = timebase_now_us() + period_us;
+}
+
+
+/**
+ * Returns the index of the task that is running, SCHED_NO_TASK when idle
+ *
+ */
+u8 sched_current_task(void)
+{
+	return current_task;
+}
+
+
+/**
+ * Returns the number of tasks in the table
+ *
+ */
+u8 sched_num_tasks(void)
+{
+	return num_tasks;
+}
+
+
+/**
+ * Returns the task descriptor for a task index, NULL if out of range
+ *
+ */
+const sched_task_t *sched_get_task(u8 id)
+{
+	return (id < num_tasks) ? &tasks[id] : NULL;
+}
+
+
+/**
+ * Returns the statistics for a task index, NULL if out of range
+ *
+ */
+const sched_stats_t *sched_get_stats(u8 id)
+{
+	return (id < num_tasks) ? &tasks[id].stats : NULL;
+}
+
+
+/**
+ * Clears the statistics of every task
+ *
+ */
+void sched_reset_stats(void)
+{
+	for (u8 i = 0; i < num_tasks; i++) {
+		tasks[i].stats = (sched_stats_t) {0};
+	}
+}
+
+
+/**
+ * Prints the per-task statistics over the UART
+ *
+ */
+void sched_report(void)
+{
+	xil_printf("task,period,budget,runs,overruns,misses,max_exec,max_jitter\r\n");
+
+	for (u8 i = 0; i < num_tasks; i++) {
+		const sched_task_t *t = &tasks[i];
+		xil_printf("%s,%u,%u,%u,%u,%u,%u,%u\r\n", t->name, t->period_us, t->budget_us,
+				t->stats.runs, t->stats.overruns, t->stats.misses,
+				t->stats.max_exec_us, t->stats.max_jitter_us);
+	}
+}
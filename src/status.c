@@ -0,0 +1,133 @@
+/****************************************************************************************
+*   @file status.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Controller status on the RGB LEDs and the LED bar. See status.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "status.h"
+#include "system.h"
+#include "fault.h"
+#include "nexys4io.h"
+
+/************************** Constant Definitions ***************************/
+#define STATUS_NUM_LEDS		16
+
+// RGB_CNTRL channel enables
+#define CH_R				0x4
+#define CH_G				0x2
+#define CH_B				0x1
+
+/**************************** Type Definitions *****************************/
+// What the LED registers hold, or should hold
+typedef struct {
+	u32 leds;
+	u32 rgb1_cntrl;
+	u32 rgb2_cntrl;
+} status_regs_t;
+
+/***************************** Global variables ****************************/
+static status_snap_t snap;
+static status_regs_t shadow;
+static bool shadow_valid = false;
+static u8 blink_count = 0;
+
+/************************** Function Definitions ***************************/
+/**
+ * Sets the duty cycle of every channel once and forces the next render to write
+ * all registers. Only the channel enables change after this
+ *
+ */
+void status_init(void)
+{
+	u32 dc = (STATUS_RGB_DC << 16) | (STATUS_RGB_DC << 8) | STATUS_RGB_DC;
+
+	NX4IO_RGBLED_setRGB_DATA(RGB1, dc);
+	NX4IO_RGBLED_setRGB_DATA(RGB2, dc);
+
+	snap.error = 0;
+	snap.pwm = 0;
+	snap.saturated = false;
+	shadow_valid = false;
+}
+
+
+/**
+ * Returns the snapshot the control tick writes into
+ *
+ */
+status_snap_t *status_snapshot(void)
+{
+	return &snap;
+}
+
+
+/**
+ * Works out the LED values and writes the registers that changed
+ *
+ * @param   mode    application mode (SET_MODE, RUN_MODE, ...)
+ *
+ */
+void status_render(u8 mode)
+{
+	status_regs_t want;
+	bool driving = (mode == RUN_MODE || mode == CRASH_MODE || mode == CHAR_MODE);
+	u8 fst = fault_state();
+
+	bool blink = (++blink_count & 0x4) != 0;	// about 2.5 Hz at a 50 ms render period
+
+	// LED bar: duty cycle, rounded to the nearest LED
+	u8 n = driving ? (snap.pwm * STATUS_NUM_LEDS + 127) / 255 : 0;
+	want.leds = (1u << n) - 1;
+
+	// RGB1: error magnitude and saturation
+	if (driving) {
+		u16 mag = (snap.error < 0) ? -snap.error : snap.error;
+
+		if (mag < STATUS_ERR_SMALL)
+			want.rgb1_cntrl = CH_G;
+		else if (mag < STATUS_ERR_LARGE)
+			want.rgb1_cntrl = CH_R | CH_G;
+		else
+			want.rgb1_cntrl = CH_R;
+
+		if (snap.saturated)
+			want.rgb1_cntrl |= CH_B;
+	}
+	else {
+		want.rgb1_cntrl = 0;
+	}
+
+	// RGB2: fault state first, then mode
+	if (fst == FAULT_ST_LATCHED)
+		want.rgb2_cntrl = blink ? CH_R : 0;
+	else if (fst >= FAULT_ST_RAMP_DOWN)
+		want.rgb2_cntrl = CH_R;
+	else if (fst == FAULT_ST_DEGRADED)
+		want.rgb2_cntrl = CH_R | CH_G;
+	else if (mode == RUN_MODE)
+		want.rgb2_cntrl = CH_G;
+	else if (mode == DIAG_MODE)
+		want.rgb2_cntrl = CH_G | CH_B;
+	else if (mode == CHAR_MODE)
+		want.rgb2_cntrl = CH_R | CH_B;
+	else if (mode == CRASH_MODE)
+		want.rgb2_cntrl = CH_R;
+	else
+		want.rgb2_cntrl = CH_B;
+
+	// only touch the registers that changed
+	if (!shadow_valid || want.leds != shadow.leds)
+		NX4IO_setLEDs(want.leds);
+	if (!shadow_valid || want.rgb1_cntrl != shadow.rgb1_cntrl)
+		NX4IO_RGBLED_setRGB_CNTRL(RGB1, want.rgb1_cntrl);
+	if (!shadow_valid || want.rgb2_cntrl != shadow.rgb2_cntrl)
+		NX4IO_RGBLED_setRGB_CNTRL(RGB2, want.rgb2_cntrl);
+
+	shadow = want;
+	shadow_valid = true;
+}
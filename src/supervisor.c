@@ -0,0 +1,243 @@
+/****************************************************************************************
+*   @file supervisor.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Watchdog supervisor. See supervisor.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "supervisor.h"
+#include "timebase.h"
+#include "system.h"
+#include "sections.h"
+
+/************************** Constant Definitions ***************************/
+#define SUP_MAGIC			0x53555056		// "SUPV"
+#define SUP_NO_CHANNEL		0xFF
+
+/**************************** Type Definitions *****************************/
+// Record kept in .noinit so that it survives a watchdog reset
+typedef struct {
+	u32 magic;
+	u32 boot_count;
+	u8 pending_cause;		// cause written just before the watchdog is starved
+	u8 failed_ch;			// channel that missed its deadline, if any
+} sup_record_t;
+
+/***************************** Global variables ****************************/
+static sup_record_t sup_record NOINIT_DATA;
+
+static XWdtTb *wdt_inst = NULL;
+static u32 deadline_us[SUP_NUM_CH];
+static u32 last_checkin_us[SUP_NUM_CH];
+static u8 armed_mask = 0;
+static bool starving = false;		// true once we have stopped kicking the watchdog
+static u8 boot_cause = SUP_CAUSE_POWER_ON;
+static u8 boot_failed_ch = SUP_NO_CHANNEL;
+
+/************************** Function Definitions ***************************/
+/**
+ * Initializes the supervisor and works out why we came out of reset
+ *
+ * @param   wdt     initialized timebase watchdog instance
+ *
+ */
+void sup_init(XWdtTb *wdt)
+{
+	wdt_inst = wdt;
+	armed_mask = 0;
+	starving = false;
+
+	if (sup_record.magic != SUP_MAGIC) {
+		// BRAM holds garbage: first boot since configuration
+		sup_record.magic = SUP_MAGIC;
+		sup_record.boot_count = 0;
+		boot_cause = SUP_CAUSE_POWER_ON;
+		boot_failed_ch = SUP_NO_CHANNEL;
+	}
+	else if (sup_record.pending_cause != SUP_CAUSE_NONE) {
+		boot_cause = sup_record.pending_cause;
+		boot_failed_ch = sup_record.failed_ch;
+	}
+	else {
+		boot_cause = SUP_CAUSE_UNKNOWN;
+		boot_failed_ch = SUP_NO_CHANNEL;
+	}
+
+	sup_record.boot_count++;
+	sup_record.pending_cause = SUP_CAUSE_NONE;
+	sup_record.failed_ch = SUP_NO_CHANNEL;
+
+	for (u8 ch = 0; ch < SUP_NUM_CH; ch++) {
+		deadline_us[ch] = SUP_DEFAULT_DEADLINE_US;
+		last_checkin_us[ch] = 0;
+	}
+}
+
+
+/**
+ * Sets the maximum time allowed between two check-ins of a channel
+ *
+ * @note    A changed deadline counts from now, so shortening it does not
+ *          fail a channel that checked in under the old one
+ *
+ */
+void sup_set_deadline(u8 ch, u32 deadline)
+{
+	if (ch >= SUP_NUM_CH || deadline == deadline_us[ch])
+		return;
+
+	deadline_us[ch] = deadline;
+	last_checkin_us[ch] = timebase_now_us();
+}
+
+
+/**
+ * Selects which channels have to check in for the watchdog to be kicked
+ *
+ * @param   mask    SUP_MASK() of each channel to supervise
+ *
+ * @note    Newly armed channels get a full deadline from now
+ *
+ */
+void sup_arm(u8 mask)
+{
+	u32 now = timebase_now_us();
+
+	for (u8 ch = 0; ch < SUP_NUM_CH; ch++) {
+		if ((mask & SUP_MASK(ch)) && !(armed_mask & SUP_MASK(ch)))
+			last_checkin_us[ch] = now;
+	}
+
+	armed_mask = mask;
+}
+
+
+/**
+ * Records that a critical channel has done its work for this period
+ *
+ */
+HOT_CODE void sup_checkin(u8 ch)
+{
+	if (ch < SUP_NUM_CH)
+		last_checkin_us[ch] = timebase_now_us();
+}
+
+
+/**
+ * Kicks the watchdog if every armed channel is alive, otherwise puts the
+ * motor in a safe state and lets the watchdog reset the system
+ *
+ * @note    Called periodically from the watchdog task. Once a reset has been
+ *          requested the safe state is re-applied on each call until the
+ *          watchdog fires
+ *
+ */
+void sup_service(void)
+{
+	if (starving) {
+		sup_safe_state();
+		return;
+	}
+
+	u32 now = timebase_now_us();
+
+	for (u8 ch = 0; ch < SUP_NUM_CH; ch++) {
+		if (!(armed_mask & SUP_MASK(ch)))
+			continue;
+
+		if (now - last_checkin_us[ch] > deadline_us[ch]) {
+			sup_record.failed_ch = ch;
+			sup_request_reset(SUP_CAUSE_DEADLINE);
+			return;
+		}
+	}
+
+	XWdtTb_RestartWdt(wdt_inst);
+}
+
+
+/**
+ * Stops the motor, records the cause and stops kicking the watchdog
+ *
+ * @param   cause   one of the SUP_CAUSE_* values
+ *
+ */
+void sup_request_reset(u8 cause)
+{
+	sup_safe_state();
+
+	sup_record.pending_cause = cause;
+	starving = true;
+}
+
+
+/**
+ * Drives the H-bridge to a safe state: disabled, PWM = 0
+ *
+ */
+void sup_safe_state(void)
+{
+	PMODHB3_SetConfig(&HB3_Inst, 0);
+}
+
+
+/**
+ * Returns false once a reset has been requested: the bridge has to stay in
+ * the safe state until the watchdog fires
+ *
+ */
+HOT_CODE bool sup_actuation_allowed(void)
+{
+	return !starving;
+}
+
+
+/**
+ * Returns the cause of the last reset, determined by sup_init()
+ *
+ */
+u8 sup_reset_cause(void)
+{
+	return boot_cause;
+}
+
+
+/**
+ * Returns the channel that missed its deadline before the last reset,
+ * 0xFF if the last reset was not caused by a missed deadline
+ *
+ */
+u8 sup_failed_channel(void)
+{
+	return boot_failed_ch;
+}
+
+
+/**
+ * Returns the number of boots since the FPGA was configured
+ *
+ */
+u32 sup_boot_count(void)
+{
+	return sup_record.boot_count;
+}
+
+
+/**
+ * Returns a printable name for a reset cause
+ *
+ */
+const char *sup_cause_str(u8 cause)
+{
+	switch (cause) {
+		case SUP_CAUSE_POWER_ON:	return "power-on";
+		case SUP_CAUSE_DEADLINE:	return "deadline miss";
+		case SUP_CAUSE_USER:		return "user request";
+		case SUP_CAUSE_UNKNOWN:		return "unknown";
+		default:					return "none";
+	}
+}
@@ -0,0 +1,198 @@
+/****************************************************************************************
+*   @file timebase.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Free-running microsecond timebase. See timebase.h
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "timebase.h"
+#include "system.h"
+#include "sections.h"
+
+#ifndef HOST_BUILD
+#include "xtmrctr.h"
+#endif
+
+/***************************** Global variables ****************************/
+#ifdef HOST_BUILD
+static u32 virtual_us = 0;
+#else
+static XTmrCtr timer_Inst;
+static u32 last_ticks = 0;		// timer value at the previous timebase_now_us() call
+static u32 rem_ticks = 0;		// ticks not yet converted to whole microseconds
+static u32 now_us = 0;			// accumulated microseconds since timebase_init()
+#endif
+
+/************************** Function Definitions ***************************/
+#ifndef HOST_BUILD
+/**
+ * Timer driver callback. The driver has already stopped a one-shot counter,
+ * waking the processor is all the alarm is for
+ *
+ */
+static void alarm_expired(void *ref, u8 tmr_num)
+{
+	(void)ref;
+	(void)tmr_num;
+}
+#endif
+
+
+/**
+ * Starts the free-running timer used as the system timebase
+ *
+ * @return  XST_SUCCESS if the timer was started, XST_FAILURE otherwise
+ *
+ */
+XStatus timebase_init(void)
+{
+#ifdef HOST_BUILD
+	virtual_us = 0;
+	return XST_SUCCESS;
+#else
+	XStatus sts;
+
+	sts = XTmrCtr_Initialize(&timer_Inst, TIMEBASE_DEVICE_ID);
+	if (sts != XST_SUCCESS)
+		return XST_FAILURE;
+
+	// count up and reload on overflow so the counter free-runs
+	XTmrCtr_SetOptions(&timer_Inst, TIMEBASE_TMR_NUM, XTC_AUTO_RELOAD_OPTION);
+	XTmrCtr_SetResetValue(&timer_Inst, TIMEBASE_TMR_NUM, 0);
+	XTmrCtr_Start(&timer_Inst, TIMEBASE_TMR_NUM);
+
+	// the alarm counts down once and raises the interrupt when it expires
+	XTmrCtr_SetHandler(&timer_Inst, alarm_expired, NULL);
+	XTmrCtr_SetOptions(&timer_Inst, TIMEBASE_ALARM_TMR_NUM, XTC_INT_MODE_OPTION | XTC_DOWN_COUNT_OPTION);
+
+	last_ticks = XTmrCtr_GetValue(&timer_Inst, TIMEBASE_TMR_NUM);
+	rem_ticks = 0;
+	now_us = 0;
+
+	return XST_SUCCESS;
+#endif
+}
+
+
+/**
+ * Returns the raw timer count. Used where sub-microsecond resolution matters
+ *
+ * @return  the current timer count (wraps at 2^32)
+ *
+ */
+u32 timebase_now_ticks(void)
+{
+#ifdef HOST_BUILD
+	return virtual_us;
+#else
+	return XTmrCtr_GetValue(&timer_Inst, TIMEBASE_TMR_NUM);
+#endif
+}
+
+
+/**
+ * Returns the number of timer ticks per microsecond
+ *
+ */
+u32 timebase_ticks_per_us(void)
+{
+#ifdef HOST_BUILD
+	return 1;
+#else
+	return TIMEBASE_CLOCK_FREQ_HZ / TIMEBASE_US_PER_SEC;
+#endif
+}
+
+
+/**
+ * Returns the number of microseconds since timebase_init()
+ *
+ * @return  microseconds (wraps at 2^32, roughly every 71 minutes)
+ *
+ * @note    The raw 32-bit counter wraps every 43 s at 100 MHz, so the elapsed
+ *          ticks are accumulated here. This must be called at least once per
+ *          counter wrap, which the scheduler does on every pass.
+ *
+ */
+HOT_CODE u32 timebase_now_us(void)
+{
+#ifdef HOST_BUILD
+	return virtual_us;
+#else
+	u32 ticks = XTmrCtr_GetValue(&timer_Inst, TIMEBASE_TMR_NUM);
+	u32 tpu = TIMEBASE_CLOCK_FREQ_HZ / TIMEBASE_US_PER_SEC;
+
+	rem_ticks += ticks - last_ticks;
+	last_ticks = ticks;
+
+	while (rem_ticks >= tpu) {
+		// usually a handful of iterations; avoids a software divide
+		if (rem_ticks >= (tpu << 10)) {
+			now_us += 1024;
+			rem_ticks -= tpu << 10;
+		}
+		else {
+			now_us++;
+			rem_ticks -= tpu;
+		}
+	}
+
+	return now_us;
+#endif
+}
+
+
+/**
+ * Raises the timer interrupt after a delay
+ *
+ * @param   us  delay in microseconds, at most TIMEBASE_ALARM_MAX_US
+ *
+ * @note    Rearming replaces an alarm that has not expired yet. On the host
+ *          there is no interrupt; the idle loop advances the clock instead
+ *
+ */
+void timebase_set_alarm_us(u32 us)
+{
+#ifdef HOST_BUILD
+	(void)us;
+#else
+	if (us > TIMEBASE_ALARM_MAX_US)
+		us = TIMEBASE_ALARM_MAX_US;
+
+	XTmrCtr_Stop(&timer_Inst, TIMEBASE_ALARM_TMR_NUM);
+	XTmrCtr_SetResetValue(&timer_Inst, TIMEBASE_ALARM_TMR_NUM,
+						  us * (TIMEBASE_CLOCK_FREQ_HZ / TIMEBASE_US_PER_SEC));
+	XTmrCtr_Start(&timer_Inst, TIMEBASE_ALARM_TMR_NUM);
+#endif
+}
+
+
+/**
+ * Timer interrupt handler, connect it to the interrupt controller
+ *
+ */
+void timebase_isr(void *ref)
+{
+	(void)ref;
+#ifndef HOST_BUILD
+	XTmrCtr_InterruptHandler(&timer_Inst);
+#endif
+}
+
+
+#ifdef HOST_BUILD
+/**
+ * Advances the virtual clock (host builds only)
+ *
+ * @param   us  number of microseconds to advance
+ *
+ */
+void timebase_advance_us(u32 us)
+{
+	virtual_us += us;
+}
+#endif
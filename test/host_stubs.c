@@ -0,0 +1,46 @@
+/****************************************************************************************
+*   @file host_stubs.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note SDK functions the host build links against. Output goes to stdout,
+*         there is no register space behind Xil_In32()/Xil_Out32()
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include "xil_printf.h"
+#include "xil_io.h"
+
+/************************** Function Definitions ***************************/
+void xil_printf(const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+}
+
+
+void outbyte(char c)
+{
+	putchar(c);
+}
+
+
+u32 Xil_In32(UINTPTR addr)
+{
+	(void)addr;
+	return 0;
+}
+
+
+void Xil_Out32(UINTPTR addr, u32 value)
+{
+	(void)addr;
+	(void)value;
+}
@@ -0,0 +1,7 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef MB_INTERFACE_H
+#define MB_INTERFACE_H
+
+typedef void (*XInterruptHandler)(void *ref);
+
+#endif
@@ -0,0 +1,5 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef MICROBLAZE_SLEEP_H
+#define MICROBLAZE_SLEEP_H
+
+#endif
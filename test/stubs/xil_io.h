@@ -0,0 +1,10 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef XIL_IO_H
+#define XIL_IO_H
+
+#include "xil_types.h"
+
+u32 Xil_In32(UINTPTR addr);
+void Xil_Out32(UINTPTR addr, u32 value);
+
+#endif
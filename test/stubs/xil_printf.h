@@ -0,0 +1,8 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef XIL_PRINTF_H
+#define XIL_PRINTF_H
+
+void xil_printf(const char *fmt, ...);
+void outbyte(char c);
+
+#endif
@@ -0,0 +1,13 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef XINTC_H
+#define XINTC_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+#include "mb_interface.h"
+
+typedef struct {
+	u32 unused;
+} XIntc;
+
+#endif
@@ -0,0 +1,15 @@
+/* Host stand-in for the generated BSP header. Only the values the host build
+ * expands are defined */
+#ifndef XPARAMETERS_H
+#define XPARAMETERS_H
+
+#define XPAR_CPU_CORE_CLOCK_FREQ_HZ			100000000
+#define XPAR_CPU_M_AXI_DP_FREQ_HZ			100000000
+#define XPAR_TMRCTR_0_DEVICE_ID				0
+#define XPAR_TMRCTR_0_CLOCK_FREQ_HZ			100000000
+#define XPAR_INTC_0_DEVICE_ID				0
+#define XPAR_UARTLITE_1_DEVICE_ID			1
+#define XPAR_UARTLITE_1_BASEADDR			0x40600000
+#define STDOUT_BASEADDRESS					0x40600000
+
+#endif
@@ -0,0 +1,12 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef XSTATUS_H
+#define XSTATUS_H
+
+#include "xil_types.h"
+
+typedef int XStatus;
+
+#define XST_SUCCESS		0L
+#define XST_FAILURE		1L
+
+#endif
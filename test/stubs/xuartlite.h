@@ -0,0 +1,12 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef XUARTLITE_H
+#define XUARTLITE_H
+
+#include "xil_types.h"
+#include "xstatus.h"
+
+typedef struct {
+	u32 unused;
+} XUartLite;
+
+#endif
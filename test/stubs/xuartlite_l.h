@@ -0,0 +1,8 @@
+/* Host stand-in for the SDK header of the same name */
+#ifndef XUARTLITE_L_H
+#define XUARTLITE_L_H
+
+#include "xil_types.h"
+#include "xil_io.h"
+
+#endif
@@ -0,0 +1,43 @@
+/****************************************************************************************
+*   @file test.h
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Minimal check macros for the host tests. A failed check prints its
+*         location and the test keeps going, main() returns test_result()
+*
+*******************************************************************************************/
+#ifndef __TEST_H__
+#define __TEST_H__
+
+/******************Header files***************************/
+#include <stdio.h>
+
+/*********** Macros **********/
+static int test_failures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			test_failures++; \
+		} \
+	} while (0)
+
+#define CHECK_EQ(a, b) \
+	do { \
+		long long a_ = (long long)(a), b_ = (long long)(b); \
+		if (a_ != b_) { \
+			printf("%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #a, a_, b_); \
+			test_failures++; \
+		} \
+	} while (0)
+
+static inline int test_result(const char *name)
+{
+	printf("%s: %s\n", name, test_failures ? "FAIL" : "PASS");
+	return test_failures ? 1 : 0;
+}
+
+#endif
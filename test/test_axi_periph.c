@@ -0,0 +1,127 @@
+/****************************************************************************************
+*   @file test_axi_periph.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Host test of the AXI peripheral handle: the RAM register file a
+*         handle gets from AXI_Periph_Init(), a driver (PmodENC544) running on
+*         it, and a register model installed with AXI_Periph_AttachSim()
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "test.h"
+#include "axi_periph.h"
+#include "PmodENC544.h"
+
+/************************** Constant Definitions ***************************/
+#define ENC_BASE		0x44A10000u
+#define MODEL_BASE		0x44A30000u
+
+/***************************** Global variables ****************************/
+static u32 model_last_addr = 0;
+static u32 model_last_data = 0;
+static u32 model_reads = 0;
+
+/************************** Function Definitions ***************************/
+static u32 model_read(u32 addr)
+{
+	model_reads++;
+	model_last_addr = addr;
+	return ~addr;
+}
+
+static void model_write(u32 addr, u32 data)
+{
+	model_last_addr = addr;
+	model_last_data = data;
+}
+
+
+/**
+ * A zero base address is refused, otherwise the handle reads back what was
+ * written through it
+ *
+ */
+static void test_register_file(void)
+{
+	AXI_Periph io;
+
+	CHECK(AXI_Periph_Init(&io, 0) == XST_FAILURE);
+	CHECK(AXI_Periph_Init(&io, ENC_BASE) == XST_SUCCESS);
+
+	for (u32 off = 0; off < AXI_PERIPH_SIM_REGS * 4; off += 4)
+		AXI_Periph_Write(&io, off, 0xC0DE0000u | off);
+	for (u32 off = 0; off < AXI_PERIPH_SIM_REGS * 4; off += 4)
+		CHECK_EQ(AXI_Periph_Read(&io, off), 0xC0DE0000u | off);
+}
+
+
+/**
+ * The encoder driver runs unchanged on the register file: the values a test
+ * puts in the registers come back through the driver's accessors
+ *
+ */
+static void test_encoder_driver(void)
+{
+	PMODENC544 enc;
+	AXI_Periph regs;
+
+	CHECK(AXI_Periph_Init(&regs, ENC_BASE) == XST_SUCCESS);
+	AXI_Periph_Write(&regs, PMODENC544_CLR_ROTARY_COUNT_REG_OFFSET, 0xFFFFFFFFu);
+
+	CHECK(PMODENC544_initialize(&enc, 0) == XST_FAILURE);
+	CHECK(PMODENC544_initialize(&enc, ENC_BASE) == XST_SUCCESS);
+
+	// the clear is a 1 then 0 pulse on the clear register
+	CHECK_EQ(AXI_Periph_Read(&regs, PMODENC544_CLR_ROTARY_COUNT_REG_OFFSET), 0);
+
+	AXI_Periph_Write(&regs, PMODENC544_ROTARY_COUNT_REG_OFFSET, 42);
+	AXI_Periph_Write(&regs, PMODENC544_BTNSWT_REG_OFFSET, 0x2);
+	CHECK_EQ(PMODENC544_getRotaryCount(&enc), 42);
+	CHECK_EQ(PMODENC544_getBtnSwReg(&enc), 0x2);
+	CHECK(!PMODENC544_isBtnPressed(&enc));
+
+	AXI_Periph_Write(&regs, PMODENC544_BTNSWT_REG_OFFSET, 0x3);
+	CHECK(PMODENC544_isBtnPressed(&enc));
+}
+
+
+/**
+ * A handle with a model attached sends every access to it with the full
+ * address and leaves the register file alone
+ *
+ */
+static void test_attached_model(void)
+{
+	AXI_Periph io;
+	AXI_Periph ram;
+
+	CHECK(AXI_Periph_Init(&ram, MODEL_BASE) == XST_SUCCESS);
+	AXI_Periph_Write(&ram, 8, 1234);
+
+	CHECK(AXI_Periph_Init(&io, MODEL_BASE) == XST_SUCCESS);
+	AXI_Periph_AttachSim(&io, model_read, model_write);
+
+	AXI_Periph_Write(&io, 8, 0x55);
+	CHECK_EQ(model_last_addr, MODEL_BASE + 8);
+	CHECK_EQ(model_last_data, 0x55);
+
+	CHECK_EQ(AXI_Periph_Read(&io, 4), ~(MODEL_BASE + 4));
+	CHECK_EQ(model_last_addr, MODEL_BASE + 4);
+	CHECK_EQ(model_reads, 1);
+
+	CHECK_EQ(AXI_Periph_Read(&ram, 8), 1234);
+	CHECK_EQ(model_reads, 1);
+}
+
+
+int main(void)
+{
+	test_register_file();
+	test_encoder_driver();
+	test_attached_model();
+
+	return test_result("test_axi_periph");
+}
@@ -0,0 +1,155 @@
+/****************************************************************************************
+*   @file test_pmodhb3.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Host test of the PMODHB3 tach sample tracking against the simulated
+*         register model: window timing of PMODHB3_PollNewSample() and
+*         PMODHB3_WaitForNewSample(), the REG2 re-read when a window closes in
+*         the middle of a sample, and the fallback for bitstreams without the
+*         sample counter
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "test.h"
+#include "PMODHB3_IP.h"
+#include "timebase.h"
+
+/************************** Constant Definitions ***************************/
+#define HB3_BASE		0x44A20000u
+#define FULL_DUTY		(1u << 9 | 255u)
+#define WINDOW			PMODHB3_TACH_WINDOW_US
+
+/***************************** Global variables ****************************/
+static PMODHB3 hb3;
+
+/************************** Function Definitions ***************************/
+static void setup(bool hasCounter, u32 readDelay)
+{
+	timebase_init();
+	PMODHB3_Sim_SetReadDelay(0);
+	PMODHB3_Sim_Reset(HB3_BASE, hasCounter);
+	CHECK(PMODHB3_Initialize(&hb3, HB3_BASE) == XST_SUCCESS);
+	PMODHB3_SetConfig(&hb3, FULL_DUTY);
+	PMODHB3_Sim_SetReadDelay(readDelay);
+}
+
+
+/**
+ * A sample is new exactly once per window, at the window end, and carries the
+ * counter and the timestamp of that window
+ *
+ */
+static void test_window_timing(void)
+{
+	PMODHB3_Sample s;
+	u32 fresh = 0;
+	u32 last_rpm = 0;
+
+	setup(true, 0);
+
+	for (u32 t = 0; t < 5 * WINDOW; t += 1000) {
+		if (PMODHB3_PollNewSample(&hb3, &s)) {
+			fresh++;
+			CHECK_EQ(t % WINDOW, 0);
+			CHECK_EQ(s.count, t / WINDOW);
+			CHECK_EQ(s.timestamp, t);
+			CHECK(s.rpm > last_rpm);			// still spinning up
+			last_rpm = s.rpm;
+		}
+		timebase_advance_us(1000);
+	}
+	CHECK_EQ(fresh, 4);
+	CHECK(PMODHB3_HasSampleCounter(&hb3));
+
+	// the next window closes at 5 * WINDOW, which is now
+	CHECK(PMODHB3_WaitForNewSample(&hb3, &s, WINDOW + WINDOW / 4) == XST_SUCCESS);
+	CHECK_EQ(timebase_now_us(), 5 * WINDOW);
+	CHECK_EQ(s.count, 5);
+
+	CHECK(PMODHB3_WaitForNewSample(&hb3, &s, WINDOW / 2) == XST_FAILURE);
+	CHECK_EQ(timebase_now_us(), 5 * WINDOW + WINDOW / 2);
+	CHECK_EQ(s.count, 5);
+
+	CHECK(PMODHB3_WaitForNewSample(&hb3, &s, WINDOW) == XST_SUCCESS);
+	CHECK_EQ(timebase_now_us(), 6 * WINDOW);
+	CHECK_EQ(s.count, 6);
+	CHECK_EQ(s.timestamp, 6 * WINDOW);
+}
+
+
+/**
+ * With slow register reads a window regularly closes between the first and
+ * the last read of a sample. The counter re-read must catch every one of
+ * those, so the timestamp always belongs to the counter value returned
+ *
+ */
+static void test_counter_reread(void)
+{
+	PMODHB3_Sample s;
+	u32 last_count = 0;
+	u32 retries = 0;
+
+	setup(true, 30000);
+
+	for (u16 i = 0; i < 200; i++) {
+		u32 t0 = timebase_now_us();
+
+		PMODHB3_PollNewSample(&hb3, &s);
+
+		// a clean pass is four reads, a retry reads the sample again
+		if (timebase_now_us() - t0 > 4 * 30000)
+			retries++;
+
+		CHECK_EQ(s.timestamp, s.count * WINDOW);
+		CHECK(s.count >= last_count);
+		last_count = s.count;
+	}
+
+	CHECK(retries > 0);
+	CHECK(last_count > 100);
+}
+
+
+/**
+ * Without the counter a sample is taken as new once the reading changes or a
+ * whole window has gone by
+ *
+ */
+static void test_no_counter(void)
+{
+	PMODHB3_Sample s;
+
+	setup(false, 0);
+	PMODHB3_SetConfig(&hb3, 0);
+
+	CHECK(!PMODHB3_PollNewSample(&hb3, &s));
+	timebase_advance_us(WINDOW - 1);
+	CHECK(!PMODHB3_PollNewSample(&hb3, &s));
+	timebase_advance_us(1);
+	CHECK(PMODHB3_PollNewSample(&hb3, &s));
+	CHECK(!PMODHB3_PollNewSample(&hb3, &s));
+	CHECK_EQ(s.count, 0);
+	CHECK_EQ(s.rpm, 0);
+
+	// the motor starts, the reading changes at the next window end
+	PMODHB3_SetConfig(&hb3, FULL_DUTY);
+	timebase_advance_us(WINDOW / 2);
+	CHECK(!PMODHB3_PollNewSample(&hb3, &s));
+	timebase_advance_us(WINDOW / 2);
+	CHECK(PMODHB3_PollNewSample(&hb3, &s));
+	CHECK(s.rpm > 0);
+	CHECK(!PMODHB3_HasSampleCounter(&hb3));
+}
+
+
+int main(void)
+{
+	test_window_timing();
+	test_counter_reread();
+	test_no_counter();
+
+	return test_result("test_pmodhb3");
+}
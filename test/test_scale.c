@@ -0,0 +1,125 @@
+/****************************************************************************************
+*   @file test_scale.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Host test of the divide-free RPM <-> PWM scaling. For a spread of
+*         full scale speeds, every input in range of both ratios is compared
+*         with the host's truncating division, and the on-target self-test is
+*         run to completion through its slices
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "test.h"
+#include "scale.h"
+
+/************************** Constant Definitions ***************************/
+static const u32 full_scales[] = { 1, 2, 254, 255, 256, 4097, 6000, 59999, 65534, 65535 };
+
+#define NUM_FULL_SCALES		(sizeof(full_scales) / sizeof(full_scales[0]))
+
+/************************** Function Definitions ***************************/
+/**
+ * Compares both conversions with C division over -max..max, stopping the
+ * report at the first mismatch of each
+ *
+ */
+static void check_exact(u32 full)
+{
+	bool rpm_ok = true, pwm_ok = true;
+
+	for (int32_t x = -SCALE_RPM_IN_MAX; x <= SCALE_RPM_IN_MAX && rpm_ok; x++) {
+		int32_t want = (int32_t)((int64_t)x * SCALE_PWM_FULL / (int64_t)full);
+		if (scale_rpm_to_pwm(x) != want) {
+			printf("full %u: rpm_to_pwm(%d) = %d, expected %d\n", full, x, scale_rpm_to_pwm(x), want);
+			rpm_ok = false;
+		}
+	}
+
+	for (int32_t x = -SCALE_PWM_IN_MAX; x <= SCALE_PWM_IN_MAX && pwm_ok; x++) {
+		int32_t want = (int32_t)((int64_t)x * (int64_t)full / SCALE_PWM_FULL);
+		if (scale_pwm_to_rpm(x) != want) {
+			printf("full %u: pwm_to_rpm(%d) = %d, expected %d\n", full, x, scale_pwm_to_rpm(x), want);
+			pwm_ok = false;
+		}
+	}
+
+	CHECK(rpm_ok);
+	CHECK(pwm_ok);
+}
+
+
+/**
+ * Runs the sliced self-test to completion and returns its result
+ *
+ */
+static XStatus run_selftest(u32 *steps)
+{
+	XStatus result = XST_FAILURE;
+
+	*steps = 0;
+	scale_selftest_start();
+	while (!scale_selftest_step(&result))
+		(*steps)++;
+
+	return result;
+}
+
+
+/**
+ * The compile-time ratios are the ones scale_init() builds for the default
+ *
+ */
+static void test_default_ratios(void)
+{
+	CHECK_EQ(scale_rpm_full(), SCALE_RPM_FULL);
+	check_exact(SCALE_RPM_FULL);
+}
+
+
+/**
+ * Exact over the whole input range of both ratios for every full scale
+ *
+ */
+static void test_full_scales(void)
+{
+	for (u8 i = 0; i < NUM_FULL_SCALES; i++) {
+		u32 steps;
+
+		CHECK(scale_init(full_scales[i]) == XST_SUCCESS);
+		CHECK_EQ(scale_rpm_full(), full_scales[i]);
+		check_exact(full_scales[i]);
+
+		CHECK(run_selftest(&steps) == XST_SUCCESS);
+		// every input of both ratios, one slice per step
+		CHECK_EQ(steps, (SCALE_RPM_IN_MAX + 1 + SCALE_TEST_SLICE - 1) / SCALE_TEST_SLICE +
+						(SCALE_PWM_IN_MAX + 1 + SCALE_TEST_SLICE - 1) / SCALE_TEST_SLICE - 1);
+	}
+}
+
+
+/**
+ * Full scales out of range are refused and leave the scaling as it was
+ *
+ */
+static void test_range(void)
+{
+	CHECK(scale_init(6000) == XST_SUCCESS);
+	CHECK(scale_init(0) == XST_FAILURE);
+	CHECK(scale_init(SCALE_RPM_IN_MAX + 1) == XST_FAILURE);
+	CHECK_EQ(scale_rpm_full(), 6000);
+	CHECK_EQ(scale_rpm_to_pwm(6000), 255);
+	CHECK_EQ(scale_pwm_to_rpm(-255), -6000);
+}
+
+
+int main(void)
+{
+	test_default_ratios();
+	test_full_scales();
+	test_range();
+
+	return test_result("test_scale");
+}
@@ -0,0 +1,193 @@
+/****************************************************************************************
+*   @file test_scheduler.c
+*
+*   @author Supreet Gulavani (sg7@pdx.edu)
+*   @copyright Supreet Gulavani, 2023
+*
+*   @note Host test of the scheduler under the virtual clock. Each task moves
+*         the clock forward by a fixed execution time, idle_wait() moves it to
+*         the next release, so release order, overruns, misses and jitter are
+*         exact and repeatable
+*
+*******************************************************************************************/
+
+/***************************** Include Files *******************************/
+#include "test.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "idle.h"
+
+/************************** Constant Definitions ***************************/
+enum { TASK_CTL, TASK_LOG, TASK_SLOW, NUM_TASKS };
+
+#define LOG_LEN		64
+
+/***************************** Global variables ****************************/
+static u32 exec_us[NUM_TASKS];			// clock advance per run
+static u8 order[LOG_LEN];				// task ids in dispatch order
+static u32 started[LOG_LEN];			// virtual time of each dispatch
+static u8 num_runs = 0;
+
+/************************** Function Definitions ***************************/
+static void run(u8 id)
+{
+	if (num_runs < LOG_LEN) {
+		order[num_runs] = id;
+		started[num_runs] = timebase_now_us();
+		num_runs++;
+	}
+	timebase_advance_us(exec_us[id]);
+}
+
+static void ctl_task(void)	{ run(TASK_CTL); }
+static void log_task(void)	{ run(TASK_LOG); }
+static void slow_task(void)	{ run(TASK_SLOW); }
+
+static sched_task_t task_table[NUM_TASKS] = {
+	// name		fn			period	offset	prio	budget
+	{ "ctl",	ctl_task,	1000,	0,		0,		100 },
+	{ "log",	log_task,	1000,	0,		1,		50 },
+	{ "slow",	slow_task,	4000,	200,	2,		100 },
+};
+
+
+/**
+ * Restarts the clock and the scheduler with the given execution times
+ *
+ */
+static void setup(u32 ctl, u32 log, u32 slow)
+{
+	exec_us[TASK_CTL] = ctl;
+	exec_us[TASK_LOG] = log;
+	exec_us[TASK_SLOW] = slow;
+	num_runs = 0;
+
+	timebase_init();
+	idle_init(NULL, TASK_LOG);
+	sched_init(task_table, NUM_TASKS);
+}
+
+
+/**
+ * Runs the main loop until the virtual clock reaches end_us
+ *
+ */
+static void run_until(u32 end_us)
+{
+	while ((int32_t)(timebase_now_us() - end_us) < 0) {
+		if (!sched_dispatch())
+			idle_wait(sched_next_release_us());
+	}
+}
+
+
+/**
+ * Tasks that fit their budgets: priority order on a shared release, offsets,
+ * and the latency of the lower priority task recorded as jitter
+ *
+ */
+static void test_release_order(void)
+{
+	static const u8 expect[] = {
+		TASK_CTL, TASK_LOG, TASK_SLOW,		// 0, 40, 200
+		TASK_CTL, TASK_LOG,					// 1000, 1040
+		TASK_CTL, TASK_LOG,
+		TASK_CTL, TASK_LOG,
+		TASK_CTL, TASK_LOG, TASK_SLOW,		// 4000, 4040, 4200
+	};
+	static const u32 expect_t[] = {
+		0, 40, 200, 1000, 1040, 2000, 2040, 3000, 3040, 4000, 4040, 4200
+	};
+
+	setup(40, 30, 80);
+	run_until(5000);
+
+	CHECK_EQ(num_runs, sizeof(expect));
+	for (u8 i = 0; i < sizeof(expect); i++) {
+		CHECK_EQ(order[i], expect[i]);
+		CHECK_EQ(started[i], expect_t[i]);
+	}
+
+	const sched_stats_t *ctl = sched_get_stats(TASK_CTL);
+	const sched_stats_t *log = sched_get_stats(TASK_LOG);
+	const sched_stats_t *slow = sched_get_stats(TASK_SLOW);
+
+	CHECK_EQ(ctl->runs, 5);
+	CHECK_EQ(log->runs, 5);
+	CHECK_EQ(slow->runs, 2);
+	CHECK_EQ(ctl->overruns + log->overruns + slow->overruns, 0);
+	CHECK_EQ(ctl->misses + log->misses + slow->misses, 0);
+	CHECK_EQ(ctl->max_jitter_us, 0);
+	CHECK_EQ(log->max_jitter_us, 40);
+	CHECK_EQ(log->last_jitter_us, 40);
+	CHECK_EQ(slow->max_jitter_us, 0);
+	CHECK_EQ(ctl->max_exec_us, 40);
+	CHECK_EQ(slow->last_exec_us, 80);
+}
+
+
+/**
+ * A task that runs past its budget is counted as an overrun, and releases
+ * of other tasks that pass while it runs are counted as misses and show up
+ * as jitter, without shifting their release grid
+ *
+ */
+static void test_overrun(void)
+{
+	setup(40, 60, 2500);
+	run_until(4000);
+
+	const sched_stats_t *ctl = sched_get_stats(TASK_CTL);
+	const sched_stats_t *log = sched_get_stats(TASK_LOG);
+	const sched_stats_t *slow = sched_get_stats(TASK_SLOW);
+
+	// slow runs 200..2700, the 1000 and 2000 releases collapse into one run
+	CHECK_EQ(slow->runs, 1);
+	CHECK_EQ(slow->overruns, 1);
+	CHECK_EQ(slow->max_exec_us, 2500);
+	CHECK_EQ(ctl->misses, 1);
+	CHECK_EQ(log->misses, 1);
+	CHECK_EQ(ctl->max_jitter_us, 1700);
+	CHECK_EQ(log->max_jitter_us, 1740);
+
+	// log is over its 50 us budget on every run
+	CHECK_EQ(log->overruns, log->runs);
+	CHECK_EQ(ctl->overruns, 0);
+
+	// back on the original grid after the overrun
+	CHECK_EQ(ctl->runs, 3);
+	CHECK_EQ(ctl->last_jitter_us, 0);
+	CHECK_EQ(sched_get_task(TASK_CTL)->next_release_us, 4000);
+}
+
+
+/**
+ * A kicked task runs at the next dispatch and keeps its release grid
+ *
+ */
+static void test_kick(void)
+{
+	setup(40, 30, 80);
+	run_until(300);
+
+	// the clock idled to the 1000 release, let ctl and log take it first
+	CHECK(sched_dispatch());
+	CHECK(sched_dispatch());
+	CHECK(!sched_dispatch());
+
+	sched_kick(TASK_SLOW);
+	CHECK(sched_dispatch());
+	CHECK_EQ(order[num_runs - 1], TASK_SLOW);
+	CHECK_EQ(sched_get_stats(TASK_SLOW)->runs, 2);
+	CHECK_EQ(sched_get_task(TASK_SLOW)->next_release_us, 4200);
+}
+
+
+int main(void)
+{
+	test_release_order();
+	test_overrun();
+	test_kick();
+
+	return test_result("test_scheduler");
+}